@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_talloc.dir/src/analyze.c.o"
+  "CMakeFiles/bench_talloc.dir/src/analyze.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/bignum.c.o"
+  "CMakeFiles/bench_talloc.dir/src/bignum.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/compiler.c.o"
+  "CMakeFiles/bench_talloc.dir/src/compiler.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/hashtable.c.o"
+  "CMakeFiles/bench_talloc.dir/src/hashtable.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/interpreter.c.o"
+  "CMakeFiles/bench_talloc.dir/src/interpreter.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/kernels.c.o"
+  "CMakeFiles/bench_talloc.dir/src/kernels.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/linkedlist.c.o"
+  "CMakeFiles/bench_talloc.dir/src/linkedlist.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/numvector.c.o"
+  "CMakeFiles/bench_talloc.dir/src/numvector.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/parser.c.o"
+  "CMakeFiles/bench_talloc.dir/src/parser.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/rational.c.o"
+  "CMakeFiles/bench_talloc.dir/src/rational.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/str.c.o"
+  "CMakeFiles/bench_talloc.dir/src/str.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/symbol.c.o"
+  "CMakeFiles/bench_talloc.dir/src/symbol.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/talloc.c.o"
+  "CMakeFiles/bench_talloc.dir/src/talloc.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/tokenizer.c.o"
+  "CMakeFiles/bench_talloc.dir/src/tokenizer.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/vector.c.o"
+  "CMakeFiles/bench_talloc.dir/src/vector.c.o.d"
+  "CMakeFiles/bench_talloc.dir/src/vm.c.o"
+  "CMakeFiles/bench_talloc.dir/src/vm.c.o.d"
+  "CMakeFiles/bench_talloc.dir/tests/bench_talloc.c.o"
+  "CMakeFiles/bench_talloc.dir/tests/bench_talloc.c.o.d"
+  "bench_talloc"
+  "bench_talloc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/bench_talloc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
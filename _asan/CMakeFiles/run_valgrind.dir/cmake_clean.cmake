@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/run_valgrind.dir/src/analyze.c.o"
+  "CMakeFiles/run_valgrind.dir/src/analyze.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/bignum.c.o"
+  "CMakeFiles/run_valgrind.dir/src/bignum.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/compiler.c.o"
+  "CMakeFiles/run_valgrind.dir/src/compiler.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/hashtable.c.o"
+  "CMakeFiles/run_valgrind.dir/src/hashtable.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/interpreter.c.o"
+  "CMakeFiles/run_valgrind.dir/src/interpreter.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/kernels.c.o"
+  "CMakeFiles/run_valgrind.dir/src/kernels.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/linkedlist.c.o"
+  "CMakeFiles/run_valgrind.dir/src/linkedlist.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/numvector.c.o"
+  "CMakeFiles/run_valgrind.dir/src/numvector.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/parser.c.o"
+  "CMakeFiles/run_valgrind.dir/src/parser.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/rational.c.o"
+  "CMakeFiles/run_valgrind.dir/src/rational.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/str.c.o"
+  "CMakeFiles/run_valgrind.dir/src/str.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/symbol.c.o"
+  "CMakeFiles/run_valgrind.dir/src/symbol.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/talloc.c.o"
+  "CMakeFiles/run_valgrind.dir/src/talloc.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/tokenizer.c.o"
+  "CMakeFiles/run_valgrind.dir/src/tokenizer.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/vector.c.o"
+  "CMakeFiles/run_valgrind.dir/src/vector.c.o.d"
+  "CMakeFiles/run_valgrind.dir/src/vm.c.o"
+  "CMakeFiles/run_valgrind.dir/src/vm.c.o.d"
+  "CMakeFiles/run_valgrind.dir/tests/run_valgrind.c.o"
+  "CMakeFiles/run_valgrind.dir/tests/run_valgrind.c.o.d"
+  "run_valgrind"
+  "run_valgrind.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/run_valgrind.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
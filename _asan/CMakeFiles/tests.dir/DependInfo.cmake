@@ -0,0 +1,36 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/analyze.c" "CMakeFiles/tests.dir/src/analyze.c.o" "gcc" "CMakeFiles/tests.dir/src/analyze.c.o.d"
+  "/root/repo/src/bignum.c" "CMakeFiles/tests.dir/src/bignum.c.o" "gcc" "CMakeFiles/tests.dir/src/bignum.c.o.d"
+  "/root/repo/src/compiler.c" "CMakeFiles/tests.dir/src/compiler.c.o" "gcc" "CMakeFiles/tests.dir/src/compiler.c.o.d"
+  "/root/repo/src/hashtable.c" "CMakeFiles/tests.dir/src/hashtable.c.o" "gcc" "CMakeFiles/tests.dir/src/hashtable.c.o.d"
+  "/root/repo/src/interpreter.c" "CMakeFiles/tests.dir/src/interpreter.c.o" "gcc" "CMakeFiles/tests.dir/src/interpreter.c.o.d"
+  "/root/repo/src/kernels.c" "CMakeFiles/tests.dir/src/kernels.c.o" "gcc" "CMakeFiles/tests.dir/src/kernels.c.o.d"
+  "/root/repo/src/linkedlist.c" "CMakeFiles/tests.dir/src/linkedlist.c.o" "gcc" "CMakeFiles/tests.dir/src/linkedlist.c.o.d"
+  "/root/repo/src/numvector.c" "CMakeFiles/tests.dir/src/numvector.c.o" "gcc" "CMakeFiles/tests.dir/src/numvector.c.o.d"
+  "/root/repo/src/parser.c" "CMakeFiles/tests.dir/src/parser.c.o" "gcc" "CMakeFiles/tests.dir/src/parser.c.o.d"
+  "/root/repo/src/rational.c" "CMakeFiles/tests.dir/src/rational.c.o" "gcc" "CMakeFiles/tests.dir/src/rational.c.o.d"
+  "/root/repo/src/str.c" "CMakeFiles/tests.dir/src/str.c.o" "gcc" "CMakeFiles/tests.dir/src/str.c.o.d"
+  "/root/repo/src/symbol.c" "CMakeFiles/tests.dir/src/symbol.c.o" "gcc" "CMakeFiles/tests.dir/src/symbol.c.o.d"
+  "/root/repo/src/talloc.c" "CMakeFiles/tests.dir/src/talloc.c.o" "gcc" "CMakeFiles/tests.dir/src/talloc.c.o.d"
+  "/root/repo/src/tokenizer.c" "CMakeFiles/tests.dir/src/tokenizer.c.o" "gcc" "CMakeFiles/tests.dir/src/tokenizer.c.o.d"
+  "/root/repo/src/vector.c" "CMakeFiles/tests.dir/src/vector.c.o" "gcc" "CMakeFiles/tests.dir/src/vector.c.o.d"
+  "/root/repo/src/vm.c" "CMakeFiles/tests.dir/src/vm.c.o" "gcc" "CMakeFiles/tests.dir/src/vm.c.o.d"
+  "/root/repo/tests/test.c" "CMakeFiles/tests.dir/tests/test.c.o" "gcc" "CMakeFiles/tests.dir/tests/test.c.o.d"
+  "/root/repo/unity/unity.c" "CMakeFiles/tests.dir/unity/unity.c.o" "gcc" "CMakeFiles/tests.dir/unity/unity.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
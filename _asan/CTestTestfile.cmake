@@ -0,0 +1,28 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_asan
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(tests "/root/repo/_asan/tests")
+set_tests_properties(tests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;36;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(gc_stress "/root/repo/_asan/interpreter" "gc_stress.rkt")
+set_tests_properties(gc_stress PROPERTIES  ENVIRONMENT "GC_THRESHOLD=1" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;52;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(gc_stress_vm "/root/repo/_asan/interpreter" "--vm" "gc_stress.rkt")
+set_tests_properties(gc_stress_vm PROPERTIES  ENVIRONMENT "GC_THRESHOLD=1" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;52;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_scalar "/root/repo/_asan/interpreter" "tokens.rkt")
+set_tests_properties(tokens_scalar PROPERTIES  ENVIRONMENT "SIMD=scalar" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;56;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_scalar_vm "/root/repo/_asan/interpreter" "--vm" "tokens.rkt")
+set_tests_properties(tokens_scalar_vm PROPERTIES  ENVIRONMENT "SIMD=scalar" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;56;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_sse2 "/root/repo/_asan/interpreter" "tokens.rkt")
+set_tests_properties(tokens_sse2 PROPERTIES  ENVIRONMENT "SIMD=sse2" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;58;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_sse2_vm "/root/repo/_asan/interpreter" "--vm" "tokens.rkt")
+set_tests_properties(tokens_sse2_vm PROPERTIES  ENVIRONMENT "SIMD=sse2" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;58;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_avx2 "/root/repo/_asan/interpreter" "tokens.rkt")
+set_tests_properties(tokens_avx2 PROPERTIES  ENVIRONMENT "SIMD=avx2" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;59;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(tokens_avx2_vm "/root/repo/_asan/interpreter" "--vm" "tokens.rkt")
+set_tests_properties(tokens_avx2_vm PROPERTIES  ENVIRONMENT "SIMD=avx2" WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;59;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(streaming "/root/repo/_asan/interpreter" "streaming.rkt")
+set_tests_properties(streaming PROPERTIES  WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;43;add_test;/root/repo/CMakeLists.txt;62;add_input_test;/root/repo/CMakeLists.txt;0;")
+add_test(streaming_vm "/root/repo/_asan/interpreter" "--vm" "streaming.rkt")
+set_tests_properties(streaming_vm PROPERTIES  WORKING_DIRECTORY "/root/repo/inputfiles" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;45;add_test;/root/repo/CMakeLists.txt;62;add_input_test;/root/repo/CMakeLists.txt;0;")
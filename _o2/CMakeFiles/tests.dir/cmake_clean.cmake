@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tests.dir/src/analyze.c.o"
+  "CMakeFiles/tests.dir/src/analyze.c.o.d"
+  "CMakeFiles/tests.dir/src/bignum.c.o"
+  "CMakeFiles/tests.dir/src/bignum.c.o.d"
+  "CMakeFiles/tests.dir/src/compiler.c.o"
+  "CMakeFiles/tests.dir/src/compiler.c.o.d"
+  "CMakeFiles/tests.dir/src/hashtable.c.o"
+  "CMakeFiles/tests.dir/src/hashtable.c.o.d"
+  "CMakeFiles/tests.dir/src/interpreter.c.o"
+  "CMakeFiles/tests.dir/src/interpreter.c.o.d"
+  "CMakeFiles/tests.dir/src/kernels.c.o"
+  "CMakeFiles/tests.dir/src/kernels.c.o.d"
+  "CMakeFiles/tests.dir/src/linkedlist.c.o"
+  "CMakeFiles/tests.dir/src/linkedlist.c.o.d"
+  "CMakeFiles/tests.dir/src/numvector.c.o"
+  "CMakeFiles/tests.dir/src/numvector.c.o.d"
+  "CMakeFiles/tests.dir/src/parser.c.o"
+  "CMakeFiles/tests.dir/src/parser.c.o.d"
+  "CMakeFiles/tests.dir/src/rational.c.o"
+  "CMakeFiles/tests.dir/src/rational.c.o.d"
+  "CMakeFiles/tests.dir/src/str.c.o"
+  "CMakeFiles/tests.dir/src/str.c.o.d"
+  "CMakeFiles/tests.dir/src/symbol.c.o"
+  "CMakeFiles/tests.dir/src/symbol.c.o.d"
+  "CMakeFiles/tests.dir/src/talloc.c.o"
+  "CMakeFiles/tests.dir/src/talloc.c.o.d"
+  "CMakeFiles/tests.dir/src/tokenizer.c.o"
+  "CMakeFiles/tests.dir/src/tokenizer.c.o.d"
+  "CMakeFiles/tests.dir/src/vector.c.o"
+  "CMakeFiles/tests.dir/src/vector.c.o.d"
+  "CMakeFiles/tests.dir/src/vm.c.o"
+  "CMakeFiles/tests.dir/src/vm.c.o.d"
+  "CMakeFiles/tests.dir/tests/test.c.o"
+  "CMakeFiles/tests.dir/tests/test.c.o.d"
+  "CMakeFiles/tests.dir/unity/unity.c.o"
+  "CMakeFiles/tests.dir/unity/unity.c.o.d"
+  "tests"
+  "tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
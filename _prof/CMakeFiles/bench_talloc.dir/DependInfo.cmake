@@ -0,0 +1,35 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/analyze.c" "CMakeFiles/bench_talloc.dir/src/analyze.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/analyze.c.o.d"
+  "/root/repo/src/bignum.c" "CMakeFiles/bench_talloc.dir/src/bignum.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/bignum.c.o.d"
+  "/root/repo/src/compiler.c" "CMakeFiles/bench_talloc.dir/src/compiler.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/compiler.c.o.d"
+  "/root/repo/src/hashtable.c" "CMakeFiles/bench_talloc.dir/src/hashtable.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/hashtable.c.o.d"
+  "/root/repo/src/interpreter.c" "CMakeFiles/bench_talloc.dir/src/interpreter.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/interpreter.c.o.d"
+  "/root/repo/src/kernels.c" "CMakeFiles/bench_talloc.dir/src/kernels.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/kernels.c.o.d"
+  "/root/repo/src/linkedlist.c" "CMakeFiles/bench_talloc.dir/src/linkedlist.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/linkedlist.c.o.d"
+  "/root/repo/src/numvector.c" "CMakeFiles/bench_talloc.dir/src/numvector.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/numvector.c.o.d"
+  "/root/repo/src/parser.c" "CMakeFiles/bench_talloc.dir/src/parser.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/parser.c.o.d"
+  "/root/repo/src/rational.c" "CMakeFiles/bench_talloc.dir/src/rational.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/rational.c.o.d"
+  "/root/repo/src/str.c" "CMakeFiles/bench_talloc.dir/src/str.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/str.c.o.d"
+  "/root/repo/src/symbol.c" "CMakeFiles/bench_talloc.dir/src/symbol.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/symbol.c.o.d"
+  "/root/repo/src/talloc.c" "CMakeFiles/bench_talloc.dir/src/talloc.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/talloc.c.o.d"
+  "/root/repo/src/tokenizer.c" "CMakeFiles/bench_talloc.dir/src/tokenizer.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/tokenizer.c.o.d"
+  "/root/repo/src/vector.c" "CMakeFiles/bench_talloc.dir/src/vector.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/vector.c.o.d"
+  "/root/repo/src/vm.c" "CMakeFiles/bench_talloc.dir/src/vm.c.o" "gcc" "CMakeFiles/bench_talloc.dir/src/vm.c.o.d"
+  "/root/repo/tests/bench_talloc.c" "CMakeFiles/bench_talloc.dir/tests/bench_talloc.c.o" "gcc" "CMakeFiles/bench_talloc.dir/tests/bench_talloc.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/interpreter.dir/src/analyze.c.o"
+  "CMakeFiles/interpreter.dir/src/analyze.c.o.d"
+  "CMakeFiles/interpreter.dir/src/bignum.c.o"
+  "CMakeFiles/interpreter.dir/src/bignum.c.o.d"
+  "CMakeFiles/interpreter.dir/src/compiler.c.o"
+  "CMakeFiles/interpreter.dir/src/compiler.c.o.d"
+  "CMakeFiles/interpreter.dir/src/hashtable.c.o"
+  "CMakeFiles/interpreter.dir/src/hashtable.c.o.d"
+  "CMakeFiles/interpreter.dir/src/interpreter.c.o"
+  "CMakeFiles/interpreter.dir/src/interpreter.c.o.d"
+  "CMakeFiles/interpreter.dir/src/kernels.c.o"
+  "CMakeFiles/interpreter.dir/src/kernels.c.o.d"
+  "CMakeFiles/interpreter.dir/src/linkedlist.c.o"
+  "CMakeFiles/interpreter.dir/src/linkedlist.c.o.d"
+  "CMakeFiles/interpreter.dir/src/main.c.o"
+  "CMakeFiles/interpreter.dir/src/main.c.o.d"
+  "CMakeFiles/interpreter.dir/src/numvector.c.o"
+  "CMakeFiles/interpreter.dir/src/numvector.c.o.d"
+  "CMakeFiles/interpreter.dir/src/parser.c.o"
+  "CMakeFiles/interpreter.dir/src/parser.c.o.d"
+  "CMakeFiles/interpreter.dir/src/rational.c.o"
+  "CMakeFiles/interpreter.dir/src/rational.c.o.d"
+  "CMakeFiles/interpreter.dir/src/str.c.o"
+  "CMakeFiles/interpreter.dir/src/str.c.o.d"
+  "CMakeFiles/interpreter.dir/src/symbol.c.o"
+  "CMakeFiles/interpreter.dir/src/symbol.c.o.d"
+  "CMakeFiles/interpreter.dir/src/talloc.c.o"
+  "CMakeFiles/interpreter.dir/src/talloc.c.o.d"
+  "CMakeFiles/interpreter.dir/src/tokenizer.c.o"
+  "CMakeFiles/interpreter.dir/src/tokenizer.c.o.d"
+  "CMakeFiles/interpreter.dir/src/vector.c.o"
+  "CMakeFiles/interpreter.dir/src/vector.c.o.d"
+  "CMakeFiles/interpreter.dir/src/vm.c.o"
+  "CMakeFiles/interpreter.dir/src/vm.c.o.d"
+  "interpreter"
+  "interpreter.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/interpreter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,36 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/analyze.c" "CMakeFiles/test_valgrind.dir/src/analyze.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/analyze.c.o.d"
+  "/root/repo/src/bignum.c" "CMakeFiles/test_valgrind.dir/src/bignum.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/bignum.c.o.d"
+  "/root/repo/src/compiler.c" "CMakeFiles/test_valgrind.dir/src/compiler.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/compiler.c.o.d"
+  "/root/repo/src/hashtable.c" "CMakeFiles/test_valgrind.dir/src/hashtable.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/hashtable.c.o.d"
+  "/root/repo/src/interpreter.c" "CMakeFiles/test_valgrind.dir/src/interpreter.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/interpreter.c.o.d"
+  "/root/repo/src/kernels.c" "CMakeFiles/test_valgrind.dir/src/kernels.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/kernels.c.o.d"
+  "/root/repo/src/linkedlist.c" "CMakeFiles/test_valgrind.dir/src/linkedlist.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/linkedlist.c.o.d"
+  "/root/repo/src/numvector.c" "CMakeFiles/test_valgrind.dir/src/numvector.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/numvector.c.o.d"
+  "/root/repo/src/parser.c" "CMakeFiles/test_valgrind.dir/src/parser.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/parser.c.o.d"
+  "/root/repo/src/rational.c" "CMakeFiles/test_valgrind.dir/src/rational.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/rational.c.o.d"
+  "/root/repo/src/str.c" "CMakeFiles/test_valgrind.dir/src/str.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/str.c.o.d"
+  "/root/repo/src/symbol.c" "CMakeFiles/test_valgrind.dir/src/symbol.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/symbol.c.o.d"
+  "/root/repo/src/talloc.c" "CMakeFiles/test_valgrind.dir/src/talloc.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/talloc.c.o.d"
+  "/root/repo/src/tokenizer.c" "CMakeFiles/test_valgrind.dir/src/tokenizer.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/tokenizer.c.o.d"
+  "/root/repo/src/vector.c" "CMakeFiles/test_valgrind.dir/src/vector.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/vector.c.o.d"
+  "/root/repo/src/vm.c" "CMakeFiles/test_valgrind.dir/src/vm.c.o" "gcc" "CMakeFiles/test_valgrind.dir/src/vm.c.o.d"
+  "/root/repo/tests/test_valgrind.c" "CMakeFiles/test_valgrind.dir/tests/test_valgrind.c.o" "gcc" "CMakeFiles/test_valgrind.dir/tests/test_valgrind.c.o.d"
+  "/root/repo/unity/unity.c" "CMakeFiles/test_valgrind.dir/unity/unity.c.o" "gcc" "CMakeFiles/test_valgrind.dir/unity/unity.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_valgrind.dir/src/analyze.c.o"
+  "CMakeFiles/test_valgrind.dir/src/analyze.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/bignum.c.o"
+  "CMakeFiles/test_valgrind.dir/src/bignum.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/compiler.c.o"
+  "CMakeFiles/test_valgrind.dir/src/compiler.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/hashtable.c.o"
+  "CMakeFiles/test_valgrind.dir/src/hashtable.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/interpreter.c.o"
+  "CMakeFiles/test_valgrind.dir/src/interpreter.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/kernels.c.o"
+  "CMakeFiles/test_valgrind.dir/src/kernels.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/linkedlist.c.o"
+  "CMakeFiles/test_valgrind.dir/src/linkedlist.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/numvector.c.o"
+  "CMakeFiles/test_valgrind.dir/src/numvector.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/parser.c.o"
+  "CMakeFiles/test_valgrind.dir/src/parser.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/rational.c.o"
+  "CMakeFiles/test_valgrind.dir/src/rational.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/str.c.o"
+  "CMakeFiles/test_valgrind.dir/src/str.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/symbol.c.o"
+  "CMakeFiles/test_valgrind.dir/src/symbol.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/talloc.c.o"
+  "CMakeFiles/test_valgrind.dir/src/talloc.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/tokenizer.c.o"
+  "CMakeFiles/test_valgrind.dir/src/tokenizer.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/vector.c.o"
+  "CMakeFiles/test_valgrind.dir/src/vector.c.o.d"
+  "CMakeFiles/test_valgrind.dir/src/vm.c.o"
+  "CMakeFiles/test_valgrind.dir/src/vm.c.o.d"
+  "CMakeFiles/test_valgrind.dir/tests/test_valgrind.c.o"
+  "CMakeFiles/test_valgrind.dir/tests/test_valgrind.c.o.d"
+  "CMakeFiles/test_valgrind.dir/unity/unity.c.o"
+  "CMakeFiles/test_valgrind.dir/unity/unity.c.o.d"
+  "test_valgrind"
+  "test_valgrind.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/test_valgrind.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
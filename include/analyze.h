@@ -0,0 +1,146 @@
+#ifndef _ANALYZE
+#define _ANALYZE
+
+#include "value.h"
+#include "interpreter.h"
+
+typedef enum {CONSTANT_NODE, VARIABLE_NODE, IF_NODE, COND_NODE, WHEN_NODE,
+              UNLESS_NODE, BEGIN_NODE, AND_NODE, OR_NODE, LET_NODE,
+              LET_STAR_NODE, LETREC_NODE, LAMBDA_NODE, DEFINE_NODE, SET_NODE,
+              DISPLAY_NODE, APPLICATION_NODE} nodeKind;
+
+// The binding of a global variable: its name, and its value, which is NULL
+// until it is defined. Each name has one, which never moves, so nodes and
+// code find it once, when they are analyzed or compiled.
+struct Global {
+    Value *symbol;
+    Value *value;
+};
+
+typedef struct Global Global;
+
+// Where execution goes next after an exec function that ends with an
+// expression in tail position: that expression, and the frame to run it in.
+// frames is the top of the frame stack when the execute loop started.
+struct Tail {
+    struct Node *node;
+    Frame *frame;
+    char *frames;
+};
+
+typedef struct Tail Tail;
+
+// An expression that has been analyzed: its syntax has been checked once, and
+// exec runs it in a frame without looking at the parse tree again. exec
+// returns the value, or NULL after putting an expression whose value is the
+// value into tail. Which fields are used depends on the kind. Nodes are
+// talloc'd.
+struct Node {
+    Value *(*exec)(struct Node *node, Frame *frame, Tail *tail);
+    nodeKind kind;
+    union {
+        // CONSTANT_NODE
+        Value *value;
+        // VARIABLE_NODE, and DEFINE_NODE and SET_NODE along with value. A
+        // local variable is in slot index of the frame depth frames out from
+        // the current one. A global one has a depth of -1, and its binding
+        // in global.
+        struct {
+            Value *symbol;
+            struct Node *value;
+            int depth;
+            int index;
+            Global *global;
+        } var;
+        // IF_NODE, and WHEN_NODE and UNLESS_NODE with body in then
+        struct {
+            struct Node *test;
+            struct Node *then;
+            struct Node *otherwise;
+        } branch;
+        // BEGIN_NODE, AND_NODE, OR_NODE, and COND_NODE with one test per
+        // item (NULL for else) in tests
+        struct {
+            int count;
+            struct Node **items;
+            struct Node **tests;
+        } seq;
+        // LET_NODE, LET_STAR_NODE and LETREC_NODE; and LAMBDA_NODE, whose
+        // params are its names, and whose body the VM compiles into code.
+        // The names take the first count of the new frame's slots, and
+        // variables defined in the body the rest. The frame escapes if a
+        // closure may capture it; otherwise it can go on the frame stack.
+        struct {
+            int count;
+            int slots;
+            bool escapes;
+            Value **names;
+            struct Node **inits;
+            struct Node *body;
+            struct Code *code;
+        } let;
+        // APPLICATION_NODE
+        struct {
+            int count;
+            struct Node *operator;
+            struct Node **args;
+        } app;
+    };
+};
+
+typedef struct Node Node;
+
+// Registers the special forms with their keywords. Call before analyze.
+void initAnalyzer();
+
+// Checks the syntax of a top-level expression and returns it as a tree of
+// Nodes, which run with a NULL frame.
+Node *analyze(Value *expr);
+
+// Runs an analyzed expression in a frame and returns its value.
+Value *execute(Node *node, Frame *frame);
+
+// The size in bytes of the frame stack.
+#define FRAME_STACK_SIZE (8 << 20)
+
+// Makes a new frame inside parent with the given number of empty slots.
+Frame *makeFrame(Frame *parent, int slots);
+
+// Makes a new frame inside parent with the given number of empty slots. A
+// frame that doesn't escape is pushed on the frame stack if there is room,
+// and lasts until releaseFrames pops it.
+Frame *enterFrame(Frame *parent, int slots, bool escapes);
+
+// Returns the top of the frame stack, for releaseFrames to go back to.
+char *frameStackTop();
+
+// Pops every frame pushed on the frame stack since it was at top.
+void releaseFrames(char *top);
+
+// Call after storing a Value into a frame that may have been made a while
+// ago.
+void frameBarrier(Frame *frame);
+
+// Returns the value of a local variable, or exits if its define hasn't run.
+Value *lookUpLocal(Node *node, Frame *frame);
+
+// Stores into a variable's slot, which set! requires to be bound already.
+void setLocal(Node *node, Value *value, Frame *frame, bool isSet);
+
+// Returns the binding of the global variable named by symbol, adding an
+// unbound one the first time the name is seen.
+Global *globalCell(Value *symbol);
+
+// Returns the value of a global variable, or exits if it is unbound.
+Value *lookUpGlobal(Global *global);
+
+// Binds a global variable, replacing any value it already has.
+void defineGlobal(Global *global, Value *value);
+
+// Rebinds a global variable that is already bound.
+void setGlobal(Global *global, Value *value);
+
+// Prints a value the way display does.
+void displayValue(Value *value);
+
+#endif
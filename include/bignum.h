@@ -0,0 +1,92 @@
+#ifndef _BIGNUM
+#define _BIGNUM
+
+#include "value.h"
+
+// Integers are fixnums when they fit in an int, and BIGNUM_TYPE Values when
+// they don't. Every function here that returns an integer returns a fixnum
+// whenever the result fits in one, so each integer has only one
+// representation. The inline functions handle two fixnums themselves, and
+// only call into the bignum code when the result overflows.
+
+typedef struct Bignum Bignum;
+
+// Whether a Value is an integer, small or big.
+static inline bool isInteger(Value *value) {
+    return typeOf(value) == INT_TYPE || typeOf(value) == BIGNUM_TYPE;
+}
+
+// Returns the integer n as a fixnum if it fits, or a bignum.
+Value *makeInteger(int64_t n);
+
+// Sets *out to an integer if it fits in an int64_t, and returns whether it
+// did.
+bool integerToInt64(Value *a, int64_t *out);
+
+// Returns the integer written in decimal in the length characters at digits,
+// which are all digits.
+Value *parseInteger(char *digits, int length, bool negative);
+
+// Returns a + b, a - b or a * b, for integers that aren't both fixnums whose
+// result fits in one.
+Value *bignumAdd(Value *a, Value *b);
+Value *bignumSubtract(Value *a, Value *b);
+Value *bignumMultiply(Value *a, Value *b);
+
+// Returns the sum of two integers.
+static inline Value *integerAdd(Value *a, Value *b) {
+    int sum;
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE &&
+        !__builtin_add_overflow(intValue(a), intValue(b), &sum)) {
+        return makeInt(sum);
+    }
+    return bignumAdd(a, b);
+}
+
+// Returns the difference of two integers.
+static inline Value *integerSubtract(Value *a, Value *b) {
+    int difference;
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE &&
+        !__builtin_sub_overflow(intValue(a), intValue(b), &difference)) {
+        return makeInt(difference);
+    }
+    return bignumSubtract(a, b);
+}
+
+// Returns the product of two integers.
+static inline Value *integerMultiply(Value *a, Value *b) {
+    int product;
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE &&
+        !__builtin_mul_overflow(intValue(a), intValue(b), &product)) {
+        return makeInt(product);
+    }
+    return bignumMultiply(a, b);
+}
+
+// Divides integer a by integer b, which isn't zero, rounding the quotient
+// toward zero. The remainder has the sign of a. Either result pointer may be
+// NULL if that result isn't wanted.
+void integerDivide(Value *a, Value *b, Value **quotient, Value **remainder);
+
+// Returns the greatest common divisor of two magnitudes, or the other one if
+// either is zero.
+uint64_t smallGcd(uint64_t a, uint64_t b);
+
+// Returns the greatest common divisor of two integers, which is never
+// negative. The gcd of 0 and n is |n|.
+Value *integerGcd(Value *a, Value *b);
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b.
+int integerCompare(Value *a, Value *b);
+
+// Returns -1, 0 or 1 as an integer is negative, zero or positive.
+int integerSign(Value *a);
+
+// Returns the double closest to an integer.
+double integerToDouble(Value *a);
+
+// Prints an integer in decimal.
+void printInteger(Value *a);
+
+#endif
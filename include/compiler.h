@@ -0,0 +1,59 @@
+#ifndef _COMPILER
+#define _COMPILER
+
+#include "value.h"
+#include "analyze.h"
+
+// The instructions of the bytecode VM. Each is an int, followed by the ints
+// of its operands. The VM keeps a stack of values and a current frame.
+typedef enum {
+    CONSTANT_OP,      // k: push constant k
+    LOCAL_OP,         // k: push the local variable of the variable node in
+                      //    constant k
+    SET_LOCAL_OP,     // k: pop a value and set! the local variable of the
+                      //    set! node in constant k to it
+    BIND_OP,          // i: pop a value into slot i of the current frame
+    GLOBAL_OP,        // k: push the global variable bound in constant k
+    SET_GLOBAL_OP,    // k: pop a value and set! the global variable bound in
+                      //    constant k to it
+    DEFINE_GLOBAL_OP, // k: pop a value and define the global variable bound
+                      //    in constant k to be it
+    POP_OP,           // drop the top of the stack
+    JUMP_OP,          // t: continue at instruction t
+    JUMP_IF_FALSE_OP, // t m: pop a boolean and continue at t if it is #f;
+                      //      exit with message m if it isn't a boolean
+    CLOSURE_OP,       // k: push a closure of the lambda node in constant k
+    CALL_OP,          // n: call the procedure below the top n values on them
+    TAIL_CALL_OP,     // n: like CALL_OP, but a closure replaces the current
+                      //    call, and returns straight to its caller
+    RETURN_OP,        // return the top of the stack from the current call
+    FRAME_OP,         // n e: enter a new frame of n slots inside the current
+                      //      one, on the heap if e is set and otherwise on
+                      //      the frame stack
+    LEAVE_OP,         // go back to the parent of the current frame
+    DISPLAY_OP        // pop a value and print it, then push void
+} opcode;
+
+// The messages JUMP_IF_FALSE_OP exits with when the value isn't a boolean.
+typedef enum {IF_TEST, COND_TEST, AND_TEST} testKind;
+
+// Compiled bytecode, with the constants its instructions refer to. The
+// constants are Values, except for the nodes of CLOSURE_OP, LOCAL_OP and
+// SET_LOCAL_OP, and the Global bindings of the global variable instructions.
+struct Code {
+    int length;
+    int *ops;
+    int constantCount;
+    void **constants;
+};
+
+typedef struct Code Code;
+
+// Compiles an analyzed expression into code that returns its value.
+Code *compile(Node *node);
+
+// Returns the code for the body of a lambda node, compiling it the first
+// time it is asked for.
+Code *compileLambda(Node *lambda);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _HASHTABLE
+#define _HASHTABLE
+
+#include <stdbool.h>
+#include "value.h"
+
+// Returns a new, empty hash table. Its keys are compared with equal? if equal
+// is set, and with eq? otherwise.
+Value *makeHashTable(bool equal);
+
+// Returns the value that key maps to in a hash table, or NULL if it has none.
+Value *hashTableRef(Value *table, Value *key);
+
+// Maps key to value in a hash table, replacing any value it had.
+void hashTableSet(Value *table, Value *key, Value *value);
+
+// Removes key from a hash table. Returns whether it was there.
+bool hashTableRemove(Value *table, Value *key);
+
+// Binds the hash table primitives as global variables.
+void bindHashTables();
+
+// Prints a hash table, as #hash((key . value) ...) or #hasheq(...).
+void printHashTable(Value *table);
+
+#endif
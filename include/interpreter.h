@@ -1,19 +1,51 @@
 #ifndef _INTERPRETER
 #define _INTERPRETER
 
-// A frame is a linked list of bindings, and a pointer to another frame.  A
-// binding is a variable name (represented as a string), and a pointer to the
-// Value it is bound to. Specifically how you implement the list of bindings is
-// up to you.
+#include "tokenizer.h"
+
+// A frame holds the variables of one procedure call or let, in the slots the
+// analyzer assigned them, and a pointer to the frame it is nested in. Global
+// variables aren't kept in frames. A slot that is still NULL is a variable
+// whose define hasn't run yet. The slots follow the header in the same
+// block, so a frame is a single allocation.
 struct Frame {
-    Value *bindings;
     struct Frame *parent;
+    int count;
+    Value *slots[];
 };
 
 typedef struct Frame Frame;
 
-void interpret(Value *tree);
-Value *eval(Value *expr, Frame *frame);
+// Reads the top-level forms of a source one at a time, evaluating each as
+// soon as it has been read and printing its value.
+void interpret(Source *source, bool compiled);
+Value *eval(Value *expr);
+
+// Binds a primitive function to a global variable. It takes between minArgs
+// and maxArgs arguments; a maxArgs of -1 means there is no upper limit.
+void bind(char *name, Value *(*function)(int, Value **), int minArgs, int maxArgs);
+
+// Whether a Value is a number, exact or not.
+bool isNumber(Value *value);
+
+// Returns a number as a double, for mixed arithmetic.
+double toDouble(Value *number);
+
+// Whether two Values are equal?, comparing lists and vectors element by
+// element.
+bool valuesEqual(Value *first, Value *second);
+
+// The eq? and equal? primitives.
+Value *primitiveEq(int argc, Value **argv);
+Value *primitiveEqual(int argc, Value **argv);
+
+// Calls a primitive on argc arguments, once they have been checked against
+// its arity.
+Value *applyPrimitive(Value *function, int argc, Value **argv);
+
+// The loadfile primitive, which returns the parse tree of the file named by
+// its argument. Calls to it then run that tree at top level.
+Value *primitiveLoadFile(int argc, Value **argv);
 
 #endif
 
@@ -0,0 +1,79 @@
+#ifndef _KERNELS
+#define _KERNELS
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Loops over arrays of doubles and int64_ts, for the numeric vectors, and
+// over the characters of source text, for the tokenizer. Each has a portable
+// version and, on x86, versions written with SSE2 and AVX2 intrinsics. Which
+// set is used is decided once, from what the CPU supports; a kernel without a
+// vector version uses the portable one. Arithmetic on int64_ts wraps around
+// rather than overflowing, and sums and scans of doubles may add in a
+// different order than a plain loop would.
+
+// The element-wise operations a map kernel can do.
+typedef enum {KERNEL_ADD, KERNEL_SUBTRACT, KERNEL_MULTIPLY, KERNEL_DIVIDE} kernelOp;
+
+// The classes of characters the tokenizer tells apart, as bits. Whitespace
+// is also a delimiter, and digits are also symbol constituents (the
+// characters that may follow the first one of a symbol). Characters after
+// the first 128 are in no class.
+#define CHAR_WHITESPACE 1
+#define CHAR_DELIMITER 2
+#define CHAR_DIGIT 4
+#define CHAR_SYMBOL 8
+#define CHAR_INITIAL 16
+
+// The classes of each character.
+extern const unsigned char charClasses[256];
+
+// Which of 32 characters are in each class: bit i is set for character i.
+typedef struct CharMasks {
+    uint32_t whitespace;
+    uint32_t delimiters;
+    uint32_t digits;
+    uint32_t symbols;
+} CharMasks;
+
+typedef struct Kernels {
+    // The name of the instruction set: "scalar", "sse2" or "avx2".
+    char *name;
+
+    // Sets out[i] to a[i] op b[i] for i < n, or to a[i] op b[0] if scalar is
+    // set. out may be the same array as a or b. There is no KERNEL_DIVIDE for
+    // int64_ts.
+    void (*mapF64)(kernelOp op, double *out, double *a, double *b, bool scalar, int64_t n);
+    void (*mapS64)(kernelOp op, int64_t *out, int64_t *a, int64_t *b, bool scalar, int64_t n);
+
+    // Reductions of the n elements of a. min and max need n > 0. Every set
+    // gives the same min and max: a[0] if it is a NaN, and otherwise the
+    // least or greatest of the elements that aren't NaNs, with -0.0 counted
+    // as less than 0.0.
+    double (*sumF64)(double *a, int64_t n);
+    double (*minF64)(double *a, int64_t n);
+    double (*maxF64)(double *a, int64_t n);
+    double (*dotF64)(double *a, double *b, int64_t n);
+    int64_t (*sumS64)(int64_t *a, int64_t n);
+    int64_t (*minS64)(int64_t *a, int64_t n);
+    int64_t (*maxS64)(int64_t *a, int64_t n);
+    int64_t (*dotS64)(int64_t *a, int64_t *b, int64_t n);
+
+    // Sets out[i] to a[0] + ... + a[i] for i < n. out may be a.
+    void (*scanF64)(double *out, double *a, int64_t n);
+    void (*scanS64)(int64_t *out, int64_t *a, int64_t n);
+
+    // Classifies the 32 characters at text.
+    CharMasks (*classifyChars)(char *text);
+} Kernels;
+
+// Returns the kernels for the best instruction set the CPU supports, or for
+// the one named by selectKernels.
+Kernels *getKernels();
+
+// Limits the kernels to the named instruction set ("scalar", "sse2" or
+// "avx2"), if the CPU supports it. Returns false if it doesn't, or if the
+// name is unknown.
+bool selectKernels(char *name);
+
+#endif
@@ -4,9 +4,13 @@
 #ifndef _LINKEDLIST
 #define _LINKEDLIST
 
-// Create a new NULL_TYPE value node.
+// Return the NULL_TYPE value.
 Value *makeNull();
 
+// Create a new boxed value node of the given type. Integers, booleans, the
+// empty list and void are immediates; see value.h.
+Value *makeValue(valueType type);
+
 // Create a new CONS_TYPE value node.
 Value *cons(Value *newCar, Value *newCdr);
 
@@ -0,0 +1,16 @@
+#ifndef _NUMVECTOR
+#define _NUMVECTOR
+
+#include <stdbool.h>
+#include "value.h"
+
+// Binds the f64vector and s64vector primitives as global variables.
+void bindNumericVectors();
+
+// Whether two numeric vectors of the same type have equal elements.
+bool numericVectorsEqual(Value *a, Value *b);
+
+// Prints a numeric vector, as #f64(...) or #s64(...).
+void printNumericVector(Value *vector);
+
+#endif
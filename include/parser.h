@@ -1,4 +1,5 @@
 #include "value.h"
+#include "tokenizer.h"
 
 #ifndef _PARSER
 #define _PARSER
@@ -7,6 +8,10 @@
 // parse tree representing that program.
 Value *parse(Value *tokens);
 
+// Reads the next top-level datum from a source, taking only the tokens it is
+// made of, and returns its parse tree. Returns NULL at the end of the source.
+Value *readDatum(Source *source);
+
 
 // Prints the tree to the screen in a readable fashion. It should look just like
 // Racket code; use parentheses to indicate subtrees.
@@ -0,0 +1,74 @@
+#ifndef _RATIONAL
+#define _RATIONAL
+
+#include "value.h"
+#include "bignum.h"
+
+// Exact numbers are integers and RATIONAL_TYPE Values. A rational is always
+// in lowest terms with a denominator greater than 1, and a ratio whose
+// denominator would be 1 is returned as an integer instead, so equal exact
+// numbers have equal representations. The inline functions leave two
+// integers to bignum.h, and only call into the rational code otherwise.
+
+// Whether a Value is an exact number.
+static inline bool isExact(Value *value) {
+    return isInteger(value) || typeOf(value) == RATIONAL_TYPE;
+}
+
+// Returns numerator / denominator in lowest terms, for integers with a
+// nonzero denominator.
+Value *makeRational(Value *numerator, Value *denominator);
+
+// Returns a + b, a - b or a * b, for exact numbers that aren't both integers.
+Value *rationalAdd(Value *a, Value *b);
+Value *rationalSubtract(Value *a, Value *b);
+Value *rationalMultiply(Value *a, Value *b);
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b, for exact numbers that aren't both fixnums.
+int rationalCompare(Value *a, Value *b);
+
+// Returns the sum of two exact numbers.
+static inline Value *exactAdd(Value *a, Value *b) {
+    if (isInteger(a) && isInteger(b)) {
+        return integerAdd(a, b);
+    }
+    return rationalAdd(a, b);
+}
+
+// Returns the difference of two exact numbers.
+static inline Value *exactSubtract(Value *a, Value *b) {
+    if (isInteger(a) && isInteger(b)) {
+        return integerSubtract(a, b);
+    }
+    return rationalSubtract(a, b);
+}
+
+// Returns the product of two exact numbers.
+static inline Value *exactMultiply(Value *a, Value *b) {
+    if (isInteger(a) && isInteger(b)) {
+        return integerMultiply(a, b);
+    }
+    return rationalMultiply(a, b);
+}
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b.
+static inline int exactCompare(Value *a, Value *b) {
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE) {
+        return (intValue(a) > intValue(b)) - (intValue(a) < intValue(b));
+    }
+    return rationalCompare(a, b);
+}
+
+// Returns a / b for exact numbers, where b isn't zero.
+Value *exactDivide(Value *a, Value *b);
+
+// Returns a - b * q, where q is a / b rounded toward zero, for exact numbers
+// where b isn't zero. For integers this is the remainder, with the sign of a.
+Value *exactRemainder(Value *a, Value *b);
+
+// Returns the double closest to an exact number.
+double exactToDouble(Value *a);
+
+#endif
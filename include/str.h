@@ -0,0 +1,17 @@
+#ifndef _STR
+#define _STR
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "value.h"
+
+// Returns a new string holding a copy of length bytes.
+Value *makeString(char *bytes, size_t length);
+
+// Whether two strings hold the same bytes.
+bool stringsEqual(Value *a, Value *b);
+
+// Prints a string's bytes, between double quotes if quoted is set.
+void writeString(Value *string, bool quoted);
+
+#endif
@@ -0,0 +1,17 @@
+#include <stddef.h>
+#include "value.h"
+
+#ifndef _SYMBOL
+#define _SYMBOL
+
+// Returns the SYMBOL_TYPE Value for name, creating it the first time name is
+// seen. Every occurrence of a symbol shares the same Value, so two symbols are
+// the same identifier exactly when they are the same pointer. name must not
+// change afterwards; it is kept as the symbol's string.
+Value *intern(char *name);
+
+// Like intern, for a name given as the length characters at name, which need
+// not be followed by a NUL or outlive the call.
+Value *internSlice(char *name, size_t length);
+
+#endif
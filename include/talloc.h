@@ -4,15 +4,31 @@
 #ifndef _TALLOC
 #define _TALLOC
 
-// Replacement for malloc that stores the pointers allocated. It should store
-// the pointers in some kind of list; a linked list would do fine, but insert
-// here whatever code you'll need to do so; don't call functions in the
-// pre-existing linkedlist.h. Otherwise you'll end up with circular
-// dependencies, since you're going to modify the linked list to use talloc.
+// What a talloc'd block holds, which tells the collector where its pointers
+// are. Conservative memory may hold anything, so every word in it is treated
+// as a possible pointer and it is never moved. Atomic memory holds no
+// pointers at all (strings, for example). Values and Frames are traced field
+// by field, and arrays word by word as Values (NULL or not), which lets the
+// collector move them.
+typedef enum {CONSERVATIVE_KIND, ATOMIC_KIND, VALUE_KIND, FRAME_KIND, ARRAY_KIND} allocKind;
+
+// Replacement for malloc. Memory is bump-allocated out of large chunks, so
+// the pointers handed out never need to be tracked individually. Don't call
+// functions in linkedlist.h from here; the linked list is built on talloc.
+// Under tmain, memory that is no longer reachable is garbage collected. The
+// memory is zeroed and conservative; use tallocKind when the kind is known.
 void *talloc(size_t size);
 
-// Free all pointers allocated by talloc, as well as whatever memory you
-// allocated in lists to hold those pointers.
+// Like talloc, for memory of a known kind.
+void *tallocKind(size_t size, allocKind kind);
+
+// Write barrier. Must be called after storing a talloc'd pointer into an
+// object that wasn't just allocated by the same code, so that a young object
+// only reachable through an old one isn't collected.
+void tbarrier(void *object);
+
+// Free all memory allocated by talloc by releasing its chunks. Globals
+// registered with taddroot are set to NULL and unregistered.
 void tfree();
 
 // Replacement for the C function "exit", that consists of two lines: it calls
@@ -20,5 +36,35 @@ void tfree();
 // you can exit your program, and all memory is automatically cleaned up.
 void texit(int status);
 
+// Runs program(argc, argv) with the garbage collector enabled, and returns
+// its exit status. Roots are found by scanning the C stack below this call, so
+// every talloc'd pointer held in a local variable of program or anything it
+// calls stays alive. Outside of tmain nothing is freed until tfree.
+int tmain(int (*program)(int, char **), int argc, char **argv);
+
+// Sets how many bytes may be promoted out of the nursery between major
+// collections. A major collection is also put off until the old space has
+// doubled since the last one.
+void tsetthreshold(size_t bytes);
+
+// Registers a global variable that holds a talloc'd pointer, so whatever it
+// points to is kept alive. Locals need no registration.
+void taddroot(void **root);
+
+// Registers a function that reports roots held outside talloc'd memory, such
+// as a malloc'd stack of Values. At each collection it is called with visit,
+// which it must call on the address of every such pointer (a Value, which may
+// be an immediate or NULL, or any other talloc'd pointer). visit updates the
+// pointer if its object moves. For a minor collection young is true, and only
+// pointers stored since the previous collection need to be reported, since
+// everything older is known to be old.
+void taddtracer(void (*tracer)(void (*visit)(void **), bool young));
+
+// Runs a collection immediately, if the collector is enabled.
+void tcollect();
+
+// Returns the number of chunks currently held by talloc.
+int getChunkCount();
+
 #endif
 
@@ -3,8 +3,20 @@
 #ifndef _TOKENIZER
 #define _TOKENIZER
 
-// Read all of the input from stdin, and return a linked list consisting of the
-// tokens.
+// A source file that tokens are being read from.
+typedef struct Source Source;
+
+// Opens the named file for reading tokens from.
+Source *openSource(char *inputFileName);
+
+// Returns the next token of a source, or NULL at the end of it.
+Value *nextToken(Source *source);
+
+// Closes a source opened by openSource.
+void closeSource(Source *source);
+
+// Read all of the input from the named file, and return a linked list
+// consisting of the tokens.
 Value *tokenize(char *inputFileName);
 
 // Displays the contents of the linked list as tokens, with type information
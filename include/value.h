@@ -1,32 +1,153 @@
 #ifndef _VALUE
 #define _VALUE
 
+#include <stdbool.h>
+#include <stdint.h>
+
 typedef enum {INT_TYPE,DOUBLE_TYPE,STR_TYPE,CONS_TYPE,NULL_TYPE,PTR_TYPE,
               OPEN_TYPE,CLOSE_TYPE,BOOL_TYPE,SYMBOL_TYPE,
               OPEN_BRACKET_TYPE, CLOSE_BRACKET_TYPE, DOT_TYPE, SINGLE_QUOTE_TYPE, VOID_TYPE,
-              CLOSURE_TYPE, PRIMITIVE_TYPE} valueType;
+              CLOSURE_TYPE, PRIMITIVE_TYPE, BIGNUM_TYPE, RATIONAL_TYPE,
+              F64VECTOR_TYPE, S64VECTOR_TYPE, VECTOR_TYPE, OPEN_VECTOR_TYPE,
+              HASH_TABLE_TYPE} valueType;
+
+// The analyzer's scopes, which special forms are analyzed in.
+struct Scope;
+
+// A primitive procedure, implemented in C. function is called with the number
+// of arguments and an array of them, once the number has been checked to be
+// between minArgs and maxArgs (-1 for no limit).
+struct Primitive {
+    char *name;
+    int minArgs;
+    int maxArgs;
+    struct Value *(*function)(int argc, struct Value **argv);
+};
+
+typedef struct Primitive Primitive;
 
 struct Value {
     valueType type;
+    // The hash of a boxed Value for eq? hash tables, which can't use its
+    // address since the collector moves it. 0 until a table first needs it.
+    uint32_t identity;
     union {
         int i;
         double d;
         char *s;
+        // A string: length bytes, without the quotes it was written with,
+        // and their hash. bytes overlaps s, and is followed by a NUL.
+        struct String {
+            char *bytes;
+            uint32_t length;
+            uint32_t hash;
+        } str;
         void *p;
         struct ConsCell {
             struct Value *car;
             struct Value *cdr;
         } c;
         struct Closure {
-            struct Value *paramNames;
-            struct Value *functionCode;
+            struct Node *code;
             struct Frame *frame;
         } cl;
-        struct Value *(*pf)(struct Value *);
+        Primitive *prim;
+        // A SYMBOL_TYPE Value keeps its name in s (which overlaps name). If
+        // the symbol is the keyword of a special form, special analyzes it.
+        struct Symbol {
+            char *name;
+            struct Node *(*special)(struct Value *, struct Scope *);
+        } sym;
+        // An integer too big for a fixnum: the magnitude in count 32-bit
+        // digits, least significant first with no leading zeros, and the sign.
+        struct Bignum {
+            uint32_t *digits;
+            int count;
+            bool negative;
+        } big;
+        // A ratio of two integers in lowest terms, whose denominator is
+        // greater than 1.
+        struct Rational {
+            struct Value *numerator;
+            struct Value *denominator;
+        } rat;
+        // A vector: count Values in one array block.
+        struct Vector {
+            struct Value **items;
+            int64_t count;
+        } vec;
+        // An f64vector or s64vector: count unboxed doubles or int64_ts, in
+        // one atomic block.
+        struct NumericVector {
+            void *elements;
+            int64_t count;
+        } nv;
+        // A hash table of 2^sizeLog entries, count of them in use. Each entry
+        // is three Values in the slots array: the key's hash as a fixnum (NULL
+        // if the entry is empty), the key and the value. Keys are compared
+        // with equal? if equal is set, and with eq? otherwise.
+        struct HashTable {
+            struct Value **slots;
+            int count;
+            uint8_t sizeLog;
+            bool equal;
+        } ht;
     };
 };
 
 
 typedef struct Value Value;
 
+// Integers, booleans, the empty list and void are immediates: they are
+// encoded in the Value pointer itself instead of being talloc'd. A pointer
+// with its low bit set is an integer shifted left by one. One with the next
+// bit set is one of the constants below. Anything else points at a boxed
+// Value, which talloc always aligns to 8 bytes. Use typeOf rather than ->type,
+// and intValue rather than ->i, on a Value that may be an immediate.
+#define FIXNUM_TAG 1
+#define IMMEDIATE_TAG 2
+#define NULL_BITS 0x2
+#define FALSE_BITS 0x6
+#define TRUE_BITS 0xa
+#define VOID_BITS 0xe
+
+// Whether a Value is encoded in the pointer rather than talloc'd.
+static inline bool isImmediate(Value *value) {
+    return ((uintptr_t)value & (FIXNUM_TAG | IMMEDIATE_TAG)) != 0;
+}
+
+// The type of any Value, boxed or immediate.
+static inline valueType typeOf(Value *value) {
+    uintptr_t bits = (uintptr_t)value;
+    if (bits & FIXNUM_TAG) {
+        return INT_TYPE;
+    }
+    if (bits & IMMEDIATE_TAG) {
+        if (bits == NULL_BITS) {
+            return NULL_TYPE;
+        }
+        return bits == VOID_BITS ? VOID_TYPE : BOOL_TYPE;
+    }
+    return value->type;
+}
+
+static inline Value *makeInt(int i) {
+    return (Value *)(((uintptr_t)(intptr_t)i << 1) | FIXNUM_TAG);
+}
+
+static inline int intValue(Value *value) {
+    return (int)((intptr_t)value >> 1);
+}
+
+// The one and only (), #f, #t and void. Since there is exactly one of each,
+// they can be compared by pointer: a condition is false iff it == FALSE_VALUE.
+#define NULL_VALUE ((Value *)(uintptr_t)NULL_BITS)
+#define FALSE_VALUE ((Value *)(uintptr_t)FALSE_BITS)
+#define TRUE_VALUE ((Value *)(uintptr_t)TRUE_BITS)
+#define VOID_VALUE ((Value *)(uintptr_t)VOID_BITS)
+
+static inline Value *makeBool(bool b) {
+    return b ? TRUE_VALUE : FALSE_VALUE;
+}
+
 #endif
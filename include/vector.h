@@ -0,0 +1,15 @@
+#ifndef _VECTOR
+#define _VECTOR
+
+#include "value.h"
+
+// Returns a new vector of count elements, each of them fill.
+Value *makeVector(int64_t count, Value *fill);
+
+// Returns a new vector holding the elements of a list, in order.
+Value *vectorFromList(Value *list);
+
+// Binds the vector primitives as global variables.
+void bindVectors();
+
+#endif
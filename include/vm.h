@@ -0,0 +1,19 @@
+#ifndef _VM
+#define _VM
+
+#include "value.h"
+#include "interpreter.h"
+#include "compiler.h"
+
+// How many bytes the VM's value and call stacks may take up unless
+// setStackLimit says otherwise. Deeper recursion exits with an error.
+#define DEFAULT_STACK_LIMIT ((size_t)512 << 20)
+
+// Sets how many bytes the VM's stacks may take up in all.
+void setStackLimit(size_t bytes);
+
+// Runs compiled code in a frame and returns its value. Calls to closures run
+// on the VM's own stack rather than recursing in C.
+Value *runCode(Code *code, Frame *frame);
+
+#endif
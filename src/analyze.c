@@ -0,0 +1,958 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/resource.h>
+#include "value.h"
+#include "interpreter.h"
+#include "analyze.h"
+#include "talloc.h"
+#include "linkedlist.h"
+#include "parser.h"
+#include "symbol.h"
+#include "str.h"
+
+// The symbol else, which marks the default clause of a cond, define, which
+// the analyzer looks for at the start of a body, and lambda, which a
+// procedure define is rewritten into.
+Value *elseSymbol = NULL;
+Value *defineSymbol = NULL;
+Value *lambdaSymbol = NULL;
+
+// The global variables are an open-addressed hash table of their bindings,
+// keyed by symbol and probed linearly. Symbols are interned and never move,
+// so their addresses are the keys. The table and the bindings are talloc'd,
+// and the table is registered as a root.
+typedef struct GlobalTable {
+    int count;
+    int capacity;
+    Global *slots[];
+} GlobalTable;
+
+GlobalTable *globals = NULL;
+
+// How far down the C stack the evaluator may go, leaving room for primitives
+// and the collector. A procedure call below it exits with an error instead of
+// overflowing the stack.
+char *stackFloor = NULL;
+
+// The variables of a frame that is being analyzed: the names of its slots, in
+// order, and the scope of the frame it is nested in. Top-level code has a
+// NULL scope. A scope is captured if a lambda is analyzed inside it, in which
+// case a closure may keep its frame alive after the code that made it ends.
+typedef struct Scope {
+    int count;
+    int capacity;
+    Value **names;
+    struct Scope *parent;
+    bool captured;
+} Scope;
+
+// The frame stack, a malloc'd block that frames no closure can capture are
+// pushed onto and popped off of in LIFO order, so that most calls allocate
+// nothing on the heap. When it is full, frames go on the heap instead. The
+// collector finds the Values in it through traceFrames. Frames below
+// frameMark haven't been written since the last collection.
+char *frameStack = NULL;
+char *frameTop = NULL;
+char *frameMark = NULL;
+char *frameLimit = NULL;
+
+Node *analyzeIn(Value *expr, Scope *scope);
+
+// Makes a new, empty scope inside parent.
+Scope *makeScope(Scope *parent) {
+    Scope *scope = talloc(sizeof(Scope));
+    scope->capacity = 8;
+    scope->names = talloc(sizeof(Value *) * scope->capacity);
+    scope->parent = parent;
+    return scope;
+}
+
+// Returns the slot of a name in a scope, or -1 if it has none.
+int scopeSlot(Scope *scope, Value *symbol) {
+    for (int i = 0; i < scope->count; i++) {
+        if (scope->names[i] == symbol) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Gives a name a slot in a scope, unless it already has one, and returns it.
+int declare(Scope *scope, Value *symbol) {
+    int slot = scopeSlot(scope, symbol);
+    if (slot >= 0) {
+        return slot;
+    }
+    if (scope->count == scope->capacity) {
+        scope->capacity *= 2;
+        Value **names = talloc(sizeof(Value *) * scope->capacity);
+        memcpy(names, scope->names, sizeof(Value *) * scope->count);
+        scope->names = names;
+    }
+    scope->names[scope->count] = symbol;
+    return scope->count++;
+}
+
+// Works out where a variable node's symbol lives: in which enclosing frame
+// and slot, or, if no enclosing scope declares it, among the globals.
+void resolve(Node *node, Scope *scope) {
+    node->var.depth = 0;
+    while (scope != NULL) {
+        int slot = scopeSlot(scope, node->var.symbol);
+        if (slot >= 0) {
+            node->var.index = slot;
+            return;
+        }
+        node->var.depth++;
+        scope = scope->parent;
+    }
+    node->var.depth = -1;
+}
+
+// Makes a new frame inside parent with the given number of empty slots.
+Frame *makeFrame(Frame *parent, int slots) {
+    Frame *frame = tallocKind(sizeof(Frame) + sizeof(Value *) * slots, FRAME_KIND);
+    frame->parent = parent;
+    frame->count = slots;
+    return frame;
+}
+
+// Reports the pointers in the frames on the frame stack to the collector. A
+// minor collection only needs the ones written since the last collection.
+void traceFrames(void (*visit)(void **), bool young) {
+    char *current = young ? frameMark : frameStack;
+    while (current < frameTop) {
+        Frame *frame = (Frame *)current;
+        visit((void **)&frame->parent);
+        for (int i = 0; i < frame->count; i++) {
+            visit((void **)&frame->slots[i]);
+        }
+        current += sizeof(Frame) + sizeof(Value *) * frame->count;
+    }
+    frameMark = frameTop;
+}
+
+// Makes a new frame inside parent with the given number of empty slots. A
+// frame that doesn't escape is pushed on the frame stack if there is room,
+// and lasts until releaseFrames pops it.
+Frame *enterFrame(Frame *parent, int slots, bool escapes) {
+    size_t size = sizeof(Frame) + sizeof(Value *) * slots;
+    if (escapes || frameTop + size > frameLimit) {
+        return makeFrame(parent, slots);
+    }
+    if (frameTop < frameMark) {
+        frameMark = frameTop;
+    }
+    Frame *frame = (Frame *)frameTop;
+    frameTop += size;
+    frame->parent = parent;
+    frame->count = slots;
+    memset(frame->slots, 0, sizeof(Value *) * slots);
+    return frame;
+}
+
+// Returns the top of the frame stack, for releaseFrames to go back to.
+char *frameStackTop() {
+    return frameTop;
+}
+
+// Pops every frame pushed on the frame stack since it was at top.
+void releaseFrames(char *top) {
+    frameTop = top;
+}
+
+// Call after storing a Value into a frame that may have been made a while
+// ago. Frames on the frame stack are rescanned from the lowest one written.
+void frameBarrier(Frame *frame) {
+    char *address = (char *)frame;
+    if (address >= frameStack && address < frameLimit) {
+        if (address < frameMark) {
+            frameMark = address;
+        }
+    }
+    else {
+        tbarrier(frame);
+    }
+}
+
+// Exits with the error for a variable that isn't bound.
+void undefinedError(Value *symbol) {
+    printf("%s: undefined; cannot reference an identifier before its definition", symbol->s);
+    texit(1);
+}
+
+// Returns the value of a local variable, or exits if its define hasn't run.
+Value *lookUpLocal(Node *node, Frame *frame) {
+    for (int i = node->var.depth; i > 0; i--) {
+        frame = frame->parent;
+    }
+    Value *value = frame->slots[node->var.index];
+    if (value == NULL) {
+        undefinedError(node->var.symbol);
+    }
+    return value;
+}
+
+// Stores into a variable's slot, which set! requires to be bound already.
+void setLocal(Node *node, Value *value, Frame *frame, bool isSet) {
+    for (int i = node->var.depth; i > 0; i--) {
+        frame = frame->parent;
+    }
+    if (isSet && frame->slots[node->var.index] == NULL) {
+        undefinedError(node->var.symbol);
+    }
+    frame->slots[node->var.index] = value;
+    frameBarrier(frame);
+}
+
+// Hashes the address of a symbol.
+unsigned int hashSymbol(Value *symbol) {
+    uintptr_t address = (uintptr_t)symbol;
+    return (unsigned int)((address >> 4) ^ (address >> 20)) * 2654435761u;
+}
+
+// Returns the slot where the binding of symbol is, or where it would go.
+Global **findGlobal(GlobalTable *table, Value *symbol) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = hashSymbol(symbol) & mask;
+    while (table->slots[i] != NULL && table->slots[i]->symbol != symbol) {
+        i = (i + 1) & mask;
+    }
+    return &table->slots[i];
+}
+
+// Allocates an empty table with room for capacity bindings.
+GlobalTable *newGlobalTable(int capacity) {
+    GlobalTable *table = talloc(sizeof(GlobalTable) + capacity * sizeof(Global *));
+    table->count = 0;
+    table->capacity = capacity;
+    return table;
+}
+
+// Doubles the size of the global table, keeping it at most half full.
+void growGlobals() {
+    GlobalTable *old = globals;
+    globals = newGlobalTable(old->capacity * 2);
+    for (int i = 0; i < old->capacity; i++) {
+        if (old->slots[i] != NULL) {
+            *findGlobal(globals, old->slots[i]->symbol) = old->slots[i];
+            globals->count++;
+        }
+    }
+}
+
+// Returns the binding of the global variable named by symbol, adding an
+// unbound one the first time the name is seen.
+Global *globalCell(Value *symbol) {
+    Global **slot = findGlobal(globals, symbol);
+    if (*slot == NULL) {
+        Global *global = talloc(sizeof(Global));
+        global->symbol = symbol;
+        *slot = global;
+        globals->count++;
+        if (globals->count * 2 > globals->capacity) {
+            growGlobals();
+        }
+        return global;
+    }
+    return *slot;
+}
+
+// Returns the value of a global variable, or exits if it is unbound.
+Value *lookUpGlobal(Global *global) {
+    if (global->value == NULL) {
+        undefinedError(global->symbol);
+    }
+    return global->value;
+}
+
+// Binds a global variable, replacing any value it already has.
+void defineGlobal(Global *global, Value *value) {
+    global->value = value;
+}
+
+// Rebinds a global variable that is already bound.
+void setGlobal(Global *global, Value *value) {
+    if (global->value == NULL) {
+        undefinedError(global->symbol);
+    }
+    global->value = value;
+}
+
+// Exits with an error unless a condition evaluated to a boolean.
+void checkBoolean(Value *condition, char *message) {
+    if (condition != TRUE_VALUE && condition != FALSE_VALUE) {
+        printf("%s", message);
+        texit(1);
+    }
+}
+
+// Has the exec function running in a frame continue with an expression in
+// tail position, whose value is its own: execute runs it in the same loop,
+// rather than in a nested call.
+Value *tailCall(Tail *tail, Node *node, Frame *frame) {
+    tail->node = node;
+    tail->frame = frame;
+    return NULL;
+}
+
+// Runs an analyzed expression in a frame and returns its value. An exec
+// function that returns NULL has left the expression to continue with in the
+// tail, so a loop of tail calls runs in constant C stack. The frames pushed
+// on the frame stack while it runs are popped when it returns.
+Value *execute(Node *node, Frame *frame) {
+    Tail tail;
+    tail.frames = frameTop;
+    while (true) {
+        Value *value = node->exec(node, frame, &tail);
+        if (value != NULL) {
+            releaseFrames(tail.frames);
+            return value;
+        }
+        node = tail.node;
+        frame = tail.frame;
+    }
+}
+
+// Allocates a node of the given kind, which runs with exec.
+Node *makeNode(nodeKind kind, Value *(*exec)(Node *, Frame *, Tail *)) {
+    Node *node = talloc(sizeof(Node));
+    node->kind = kind;
+    node->exec = exec;
+    return node;
+}
+
+// Analyzes the first count expressions of a list into an array of nodes.
+Node **analyzeEach(Value *exprs, int count, Scope *scope) {
+    Node **nodes = talloc(sizeof(Node *) * count);
+    for (int i = 0; i < count; i++) {
+        nodes[i] = analyzeIn(car(exprs), scope);
+        exprs = cdr(exprs);
+    }
+    return nodes;
+}
+
+// Returns the value of a self-evaluating or quoted expression.
+Value *execConstant(Node *node, Frame *frame, Tail *tail) {
+    return node->value;
+}
+
+// Makes a node that evaluates to value.
+Node *makeConstant(Value *value) {
+    Node *node = makeNode(CONSTANT_NODE, execConstant);
+    node->value = value;
+    return node;
+}
+
+// Looks up a local variable.
+Value *execLocal(Node *node, Frame *frame, Tail *tail) {
+    return lookUpLocal(node, frame);
+}
+
+// Looks up a global variable.
+Value *execGlobal(Node *node, Frame *frame, Tail *tail) {
+    return lookUpGlobal(node->var.global);
+}
+
+// Analyzes a reference to a variable.
+Node *analyzeVariable(Value *symbol, Scope *scope) {
+    Node *node = makeNode(VARIABLE_NODE, execLocal);
+    node->var.symbol = symbol;
+    resolve(node, scope);
+    if (node->var.depth < 0) {
+        node->var.global = globalCell(symbol);
+        node->exec = execGlobal;
+    }
+    return node;
+}
+
+// Evaluates the condition, then the first or second branch.
+Value *execIf(Node *node, Frame *frame, Tail *tail) {
+    Value *condition = execute(node->branch.test, frame);
+    checkBoolean(condition, "Evaluation Error");
+    if (condition != FALSE_VALUE) {
+        return tailCall(tail, node->branch.then, frame);
+    }
+    else {
+        return tailCall(tail, node->branch.otherwise, frame);
+    }
+}
+
+// Analyzes the arguments of an if statement.
+Node *analyzeIf(Value *args, Scope *scope) {
+    if (length(args) != 3) {
+        printf("if: bad syntax in if");
+        texit(1);
+    }
+    Node *node = makeNode(IF_NODE, execIf);
+    node->branch.test = analyzeIn(car(args), scope);
+    node->branch.then = analyzeIn(car(cdr(args)), scope);
+    node->branch.otherwise = analyzeIn(car(cdr(cdr(args))), scope);
+    return node;
+}
+
+// Evaluates the expression of the first clause whose condition is true, or of
+// the else clause.
+Value *execCond(Node *node, Frame *frame, Tail *tail) {
+    for (int i = 0; i < node->seq.count; i++) {
+        if (node->seq.tests[i] == NULL) {
+            return tailCall(tail, node->seq.items[i], frame);
+        }
+        Value *condition = execute(node->seq.tests[i], frame);
+        checkBoolean(condition, "cond: argument not boolean");
+        if (condition != FALSE_VALUE) {
+            return tailCall(tail, node->seq.items[i], frame);
+        }
+    }
+    return VOID_VALUE;
+}
+
+// Analyzes condition, expression pairs. The else clause gets no test.
+Node *analyzeCond(Value *args, Scope *scope) {
+    Node *node = makeNode(COND_NODE, execCond);
+    node->seq.count = length(args);
+    node->seq.items = talloc(sizeof(Node *) * node->seq.count);
+    node->seq.tests = talloc(sizeof(Node *) * node->seq.count);
+    Value *current = args;
+    for (int i = 0; i < node->seq.count; i++) {
+        Value *clause = car(current);
+        if (length(clause) != 2) {
+            printf("cond: error...");
+            texit(1);
+        }
+        if (car(clause) != elseSymbol) {
+            node->seq.tests[i] = analyzeIn(car(clause), scope);
+        }
+        node->seq.items[i] = analyzeIn(car(cdr(clause)), scope);
+        current = cdr(current);
+    }
+    return node;
+}
+
+// Evaluates each expression in turn, returning the last value.
+Value *execBegin(Node *node, Frame *frame, Tail *tail) {
+    int last = node->seq.count - 1;
+    if (last < 0) {
+        return VOID_VALUE;
+    }
+    for (int i = 0; i < last; i++) {
+        execute(node->seq.items[i], frame);
+    }
+    return tailCall(tail, node->seq.items[last], frame);
+}
+
+// Analyzes a sequence of expressions.
+Node *analyzeBegin(Value *args, Scope *scope) {
+    Node *node = makeNode(BEGIN_NODE, execBegin);
+    node->seq.count = length(args);
+    node->seq.items = analyzeEach(args, node->seq.count, scope);
+    return node;
+}
+
+// Gives each variable defined at the top of a body a slot, so that the body
+// can refer to all of them, whatever order they are defined in.
+void declareDefines(Value *body, Scope *scope) {
+    while (typeOf(body) == CONS_TYPE) {
+        Value *expr = car(body);
+        if (typeOf(expr) == CONS_TYPE && car(expr) == defineSymbol && typeOf(cdr(expr)) == CONS_TYPE) {
+            Value *var = car(cdr(expr));
+            if (typeOf(var) == CONS_TYPE) {
+                var = car(var);
+            }
+            if (typeOf(var) == SYMBOL_TYPE) {
+                declare(scope, var);
+            }
+        }
+        body = cdr(body);
+    }
+}
+
+// Analyzes the body of a lambda or let, whose variables are in scope.
+Node *analyzeBody(Value *body, Scope *scope) {
+    declareDefines(body, scope);
+    return analyzeBegin(body, scope);
+}
+
+// If the condition is true, evaluates the body. Otherwise returns null.
+Value *execWhen(Node *node, Frame *frame, Tail *tail) {
+    Value *condition = execute(node->branch.test, frame);
+    checkBoolean(condition, "Evaluation Error");
+    if (condition == FALSE_VALUE) {
+        return makeNull();
+    }
+    return tailCall(tail, node->branch.then, frame);
+}
+
+// If the condition is false, evaluates the body. Otherwise returns null.
+Value *execUnless(Node *node, Frame *frame, Tail *tail) {
+    Value *condition = execute(node->branch.test, frame);
+    checkBoolean(condition, "Evaluation Error");
+    if (condition != FALSE_VALUE) {
+        return makeNull();
+    }
+    return tailCall(tail, node->branch.then, frame);
+}
+
+// Analyzes a when or unless statement: a condition and a body.
+Node *analyzeGuarded(Value *args, Scope *scope, nodeKind kind, char *name) {
+    if (length(args) < 2) {
+        printf("%s: bad syntax", name);
+        texit(1);
+    }
+    Node *node = makeNode(kind, kind == WHEN_NODE ? execWhen : execUnless);
+    node->branch.test = analyzeIn(car(args), scope);
+    node->branch.then = analyzeBegin(cdr(args), scope);
+    return node;
+}
+
+// Analyzes a when statement.
+Node *analyzeWhen(Value *args, Scope *scope) {
+    return analyzeGuarded(args, scope, WHEN_NODE, "when");
+}
+
+// Analyzes an unless statement.
+Node *analyzeUnless(Value *args, Scope *scope) {
+    return analyzeGuarded(args, scope, UNLESS_NODE, "unless");
+}
+
+// Evaluates and of any number of boolean parameters.
+Value *execAnd(Node *node, Frame *frame, Tail *tail) {
+    for (int i = 0; i < node->seq.count; i++) {
+        Value *arg = execute(node->seq.items[i], frame);
+        checkBoolean(arg, "and: arguments not boolean type");
+        if (arg == FALSE_VALUE) {
+            return arg;
+        }
+    }
+    return TRUE_VALUE;
+}
+
+// Evaluates or of any number of boolean parameters.
+Value *execOr(Node *node, Frame *frame, Tail *tail) {
+    for (int i = 0; i < node->seq.count; i++) {
+        Value *arg = execute(node->seq.items[i], frame);
+        checkBoolean(arg, "and: arguments not boolean type");
+        if (arg != FALSE_VALUE) {
+            return arg;
+        }
+    }
+    return FALSE_VALUE;
+}
+
+// Analyzes an and statement.
+Node *analyzeAnd(Value *args, Scope *scope) {
+    Node *node = analyzeBegin(args, scope);
+    node->kind = AND_NODE;
+    node->exec = execAnd;
+    return node;
+}
+
+// Analyzes an or statement.
+Node *analyzeOr(Value *args, Scope *scope) {
+    Node *node = analyzeBegin(args, scope);
+    node->kind = OR_NODE;
+    node->exec = execOr;
+    return node;
+}
+
+// Binds each name to its value, all evaluated in the enclosing frame, then
+// evaluates the body in the new frame.
+Value *execLet(Node *node, Frame *frame, Tail *tail) {
+    Value *values[node->let.count + 1];
+    for (int i = 0; i < node->let.count; i++) {
+        values[i] = execute(node->let.inits[i], frame);
+    }
+    Frame *newFrame = enterFrame(frame, node->let.slots, node->let.escapes);
+    memcpy(newFrame->slots, values, sizeof(Value *) * node->let.count);
+    return tailCall(tail, node->let.body, newFrame);
+}
+
+// Like let, but each value is evaluated in the new frame, with the names
+// before it bound. letrec is the same, except that all the names are in
+// scope of every value.
+Value *execLetStar(Node *node, Frame *frame, Tail *tail) {
+    Frame *newFrame = enterFrame(frame, node->let.slots, node->let.escapes);
+    for (int i = 0; i < node->let.count; i++) {
+        Value *value = execute(node->let.inits[i], newFrame);
+        newFrame->slots[i] = value;
+        frameBarrier(newFrame);
+    }
+    return tailCall(tail, node->let.body, newFrame);
+}
+
+// Analyzes a let, let* or letrec statement: a list of (name value) bindings
+// with distinct names, and a body. The names get the first slots of a new
+// scope. The values of a let are analyzed outside of it, those of a letrec
+// inside it, and each of a let* with only the names before it declared.
+Node *analyzeLetForm(Value *args, Scope *scope, nodeKind kind, char *name) {
+    if (length(args) < 2) {
+        printf("%s: bad syntax (missing binding pairs or body)", name);
+        texit(1);
+    }
+    Node *node = makeNode(kind, kind == LET_NODE ? execLet : execLetStar);
+    Scope *inner = makeScope(scope);
+    Value *bindings = car(args);
+    node->let.count = length(bindings);
+    node->let.names = talloc(sizeof(Value *) * node->let.count);
+    node->let.inits = talloc(sizeof(Node *) * node->let.count);
+    for (int i = 0; i < node->let.count; i++) {
+        Value *binding = car(bindings);
+        if (length(binding) != 2 || typeOf(car(binding)) != SYMBOL_TYPE) {
+            printf("%s: bad syntax (not an identifier)", name);
+            texit(1);
+        }
+        for (int j = 0; j < i; j++) {
+            if (node->let.names[j] == car(binding)) {
+                printf("%s: duplicate identifier in: %s", name, car(binding)->s);
+                texit(1);
+            }
+        }
+        node->let.names[i] = car(binding);
+        if (kind == LETREC_NODE) {
+            declare(inner, car(binding));
+        }
+        bindings = cdr(bindings);
+    }
+    bindings = car(args);
+    for (int i = 0; i < node->let.count; i++) {
+        Value *init = car(cdr(car(bindings)));
+        node->let.inits[i] = analyzeIn(init, kind == LET_NODE ? scope : inner);
+        declare(inner, node->let.names[i]);
+        bindings = cdr(bindings);
+    }
+    node->let.body = analyzeBody(cdr(args), inner);
+    node->let.slots = inner->count;
+    node->let.escapes = inner->captured;
+    return node;
+}
+
+// Analyzes a let statement.
+Node *analyzeLet(Value *args, Scope *scope) {
+    return analyzeLetForm(args, scope, LET_NODE, "let");
+}
+
+// Analyzes a let* statement.
+Node *analyzeLetStar(Value *args, Scope *scope) {
+    return analyzeLetForm(args, scope, LET_STAR_NODE, "let*");
+}
+
+// Analyzes a letrec statement.
+Node *analyzeLetRec(Value *args, Scope *scope) {
+    return analyzeLetForm(args, scope, LETREC_NODE, "letrec");
+}
+
+// Returns a closure of the lambda over the current frame.
+Value *execLambda(Node *node, Frame *frame, Tail *tail) {
+    Value *closure = makeValue(CLOSURE_TYPE);
+    closure->cl.code = node;
+    closure->cl.frame = frame;
+    return closure;
+}
+
+// Analyzes a lambda expression: a list of parameter names and a body. Its
+// closures capture the frames of every enclosing scope.
+Node *analyzeLambda(Value *args, Scope *scope) {
+    if (length(args) < 2) {
+        printf("lambda: bad syntax");
+        texit(1);
+    }
+    Node *node = makeNode(LAMBDA_NODE, execLambda);
+    for (Scope *outer = scope; outer != NULL; outer = outer->parent) {
+        outer->captured = true;
+    }
+    Value *params = car(args);
+    if (typeOf(params) != CONS_TYPE && typeOf(params) != NULL_TYPE) {
+        printf("lambda: not an identifier");
+        texit(1);
+    }
+    Scope *inner = makeScope(scope);
+    node->let.count = length(params);
+    node->let.names = talloc(sizeof(Value *) * node->let.count);
+    for (int i = 0; i < node->let.count; i++) {
+        if (typeOf(car(params)) != SYMBOL_TYPE) {
+            printf("lambda: not an identifier");
+            texit(1);
+        }
+        if (scopeSlot(inner, car(params)) >= 0) {
+            printf("lambda: duplicate argument name");
+            texit(1);
+        }
+        node->let.names[i] = car(params);
+        declare(inner, car(params));
+        params = cdr(params);
+    }
+    node->let.body = analyzeBody(cdr(args), inner);
+    node->let.slots = inner->count;
+    node->let.escapes = inner->captured;
+    return node;
+}
+
+// Binds a variable in the current frame.
+Value *execDefineLocal(Node *node, Frame *frame, Tail *tail) {
+    setLocal(node, execute(node->var.value, frame), frame, false);
+    return VOID_VALUE;
+}
+
+// Binds a global variable.
+Value *execDefineGlobal(Node *node, Frame *frame, Tail *tail) {
+    defineGlobal(node->var.global, execute(node->var.value, frame));
+    return VOID_VALUE;
+}
+
+// Analyzes a define statement, either of a variable or, when the name is a
+// list, of a procedure. At top level it defines a global variable, and
+// otherwise one in the innermost scope, which is declared before the value is
+// analyzed so that a procedure can call itself.
+Node *analyzeDefine(Value *args, Scope *scope) {
+    if (length(args) < 2) {
+        printf("define: bad syntax");
+        texit(1);
+    }
+    Node *node = makeNode(DEFINE_NODE, execDefineLocal);
+    Value *var = car(args);
+    Value *value;
+    if (typeOf(var) == CONS_TYPE) {
+        if (typeOf(car(var)) != SYMBOL_TYPE) {
+            printf("define: bad syntax (not an identifier for procedure name, and not a nested procedure form)");
+            texit(1);
+        }
+        node->var.symbol = car(var);
+        value = cons(lambdaSymbol, cons(cdr(var), cdr(args)));
+    }
+    else {
+        if (length(args) > 2) {
+            printf("define: bad syntax (multiple expressions after identifier)");
+            texit(1);
+        }
+        if (typeOf(var) != SYMBOL_TYPE) {
+            printf("define: not an identifier for procedure argument");
+            texit(1);
+        }
+        node->var.symbol = var;
+        value = car(cdr(args));
+    }
+    if (scope == NULL) {
+        node->var.depth = -1;
+        node->var.global = globalCell(node->var.symbol);
+        node->exec = execDefineGlobal;
+    }
+    else {
+        node->var.depth = 0;
+        node->var.index = declare(scope, node->var.symbol);
+    }
+    node->var.value = analyzeIn(value, scope);
+    return node;
+}
+
+// Rebinds a local variable to a new value.
+Value *execSetLocal(Node *node, Frame *frame, Tail *tail) {
+    setLocal(node, execute(node->var.value, frame), frame, true);
+    return VOID_VALUE;
+}
+
+// Rebinds a global variable to a new value.
+Value *execSetGlobal(Node *node, Frame *frame, Tail *tail) {
+    setGlobal(node->var.global, execute(node->var.value, frame));
+    return VOID_VALUE;
+}
+
+// Analyzes a set! statement.
+Node *analyzeSet(Value *args, Scope *scope) {
+    if (length(args) != 2 || typeOf(car(args)) != SYMBOL_TYPE) {
+        printf(" set!: bad syntax ");
+        texit(1);
+    }
+    Node *node = makeNode(SET_NODE, execSetLocal);
+    node->var.symbol = car(args);
+    resolve(node, scope);
+    if (node->var.depth < 0) {
+        node->var.global = globalCell(node->var.symbol);
+        node->exec = execSetGlobal;
+    }
+    node->var.value = analyzeIn(car(cdr(args)), scope);
+    return node;
+}
+
+// Prints a value. Strings are shown without their quotes.
+void displayValue(Value *value) {
+    if (typeOf(value) == STR_TYPE) {
+        writeString(value, false);
+    }
+    else {
+        printTree(value);
+    }
+}
+
+// Prints the value of the argument.
+Value *execDisplay(Node *node, Frame *frame, Tail *tail) {
+    displayValue(execute(node->var.value, frame));
+    return VOID_VALUE;
+}
+
+// Analyzes a display statement.
+Node *analyzeDisplay(Value *args, Scope *scope) {
+    if (length(args) != 1) {
+        printf("display: arity mismatch;\n"
+               " the expected number of arguments does not match the given number.");
+        texit(1);
+    }
+    Node *node = makeNode(DISPLAY_NODE, execDisplay);
+    node->var.value = analyzeIn(car(args), scope);
+    return node;
+}
+
+// Analyzes a quote expression, whose argument is left unevaluated.
+Node *analyzeQuote(Value *args, Scope *scope) {
+    if (length(args) != 1) {
+        printf("quote: bad syntax");
+        texit(1);
+    }
+    return makeConstant(car(args));
+}
+
+// Runs a parsed file at top level, printing the value of each expression.
+Value *loadForms(Value *tree) {
+    while (typeOf(tree) != NULL_TYPE) {
+        Value *result = execute(analyze(car(tree)), NULL);
+        if (typeOf(result) != VOID_TYPE) {
+            printTree(result);
+            printf("\n");
+        }
+        tree = cdr(tree);
+    }
+    return VOID_VALUE;
+}
+
+// Exits with an error if the C stack has grown past stackFloor. Every level
+// of non-tail recursion in the evaluator goes through a procedure call, so
+// calls are where it is checked.
+void checkStackDepth() {
+    char here;
+    if (&here < stackFloor) {
+        printf("stack depth exceeded");
+        texit(1);
+    }
+}
+
+// Evaluates the operator, then the arguments, and applies the one to the
+// others. A closure's arguments go into the first slots of its new frame.
+// Its body is run by the execute loop this runs in, in place of whatever
+// that loop was running, so the frames pushed there are done with.
+Value *execApplication(Node *node, Frame *frame, Tail *tail) {
+    checkStackDepth();
+    Value *function = execute(node->app.operator, frame);
+    Value *values[node->app.count + 1];
+    for (int i = 0; i < node->app.count; i++) {
+        values[i] = execute(node->app.args[i], frame);
+    }
+    if (typeOf(function) == CLOSURE_TYPE) {
+        Node *lambda = function->cl.code;
+        if (lambda->let.count != node->app.count) {
+            printf("#<procedure>: arity mismatch;\n"
+                   " the expected number of arguments does not match the given number\n");
+            texit(1);
+        }
+        releaseFrames(tail->frames);
+        Frame *newFrame = enterFrame(function->cl.frame, lambda->let.slots, lambda->let.escapes);
+        memcpy(newFrame->slots, values, sizeof(Value *) * node->app.count);
+        return tailCall(tail, lambda->let.body, newFrame);
+    }
+    if (typeOf(function) != PRIMITIVE_TYPE) {
+        printf("application: not a procedure;\n"
+               " expected a procedure that can be applied to arguments");
+        texit(1);
+    }
+    Value *result = applyPrimitive(function, node->app.count, values);
+    if (function->prim->function == primitiveLoadFile) {
+        return loadForms(result);
+    }
+    return result;
+}
+
+// Analyzes a procedure call.
+Node *analyzeApplication(Value *expr, Scope *scope) {
+    Value *first = car(expr);
+    if (typeOf(first) != SYMBOL_TYPE && typeOf(first) != CONS_TYPE) {
+        printf("application: not a procedure;\n"
+               " expected a procedure that can be applied to arguments");
+        texit(1);
+    }
+    Node *node = makeNode(APPLICATION_NODE, execApplication);
+    node->app.operator = analyzeIn(first, scope);
+    node->app.count = length(cdr(expr));
+    node->app.args = analyzeEach(cdr(expr), node->app.count, scope);
+    return node;
+}
+
+// Checks the syntax of an expression whose variables are resolved in scope,
+// and returns it as a tree of Nodes.
+Node *analyzeIn(Value *expr, Scope *scope) {
+    switch (typeOf(expr)) {
+        case SYMBOL_TYPE:
+            return analyzeVariable(expr, scope);
+        case CONS_TYPE: {
+            Value *first = car(expr);
+            if (typeOf(first) == SYMBOL_TYPE && first->sym.special != NULL) {
+                return first->sym.special(cdr(expr), scope);
+            }
+            return analyzeApplication(expr, scope);
+        }
+        default:
+            return makeConstant(expr);
+    }
+}
+
+// Checks the syntax of a top-level expression and returns it as a tree of
+// Nodes, which run with a NULL frame.
+Node *analyze(Value *expr) {
+    return analyzeIn(expr, NULL);
+}
+
+// Make a symbol the keyword of a special form, so that analyze hands
+// expressions starting with it to form rather than treating them as calls.
+void bindSpecial(char *name, Node *(*form)(Value *, Scope *)) {
+    intern(name)->sym.special = form;
+}
+
+// Registers the special forms with their keywords, and starts the globals
+// off empty. The C stack is taken to be as big as its resource limit, or
+// 256MB if it has none, and to start about here.
+void initAnalyzer() {
+    struct rlimit limit;
+    size_t size = (size_t)256 << 20;
+    if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < size) {
+        size = limit.rlim_cur;
+    }
+    char here;
+    stackFloor = &here - size + (256 << 10);
+    if (frameStack == NULL) {
+        frameStack = malloc(FRAME_STACK_SIZE);
+        frameTop = frameStack;
+        frameMark = frameStack;
+        frameLimit = frameStack + FRAME_STACK_SIZE;
+        taddtracer(traceFrames);
+    }
+    elseSymbol = intern("else");
+    defineSymbol = intern("define");
+    lambdaSymbol = intern("lambda");
+    globals = newGlobalTable(256);
+    taddroot((void **)&globals);
+
+    bindSpecial("if", analyzeIf);
+    bindSpecial("let", analyzeLet);
+    bindSpecial("let*", analyzeLetStar);
+    bindSpecial("letrec", analyzeLetRec);
+    bindSpecial("display", analyzeDisplay);
+    bindSpecial("when", analyzeWhen);
+    bindSpecial("unless", analyzeUnless);
+    bindSpecial("quote", analyzeQuote);
+    bindSpecial("define", analyzeDefine);
+    bindSpecial("set!", analyzeSet);
+    bindSpecial("lambda", analyzeLambda);
+    bindSpecial("and", analyzeAnd);
+    bindSpecial("or", analyzeOr);
+    bindSpecial("begin", analyzeBegin);
+    bindSpecial("cond", analyzeCond);
+}
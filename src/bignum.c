@@ -0,0 +1,583 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "value.h"
+#include "bignum.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// A bignum keeps its magnitude as an array of 32-bit digits, least
+// significant first and with no leading zeros, and its sign separately. The
+// functions on digit arrays below work on magnitudes alone; the ones that
+// return Values put the sign back and turn results that fit into fixnums.
+
+// Products whose shorter factor has at least this many digits are split in
+// half by Karatsuba's method. Smaller ones are multiplied digit by digit.
+#define KARATSUBA_THRESHOLD 32
+
+// Returns the digits and sign of an integer. A fixnum's one digit is put in
+// buffer.
+Bignum viewInteger(Value *value, uint32_t *buffer) {
+    if (typeOf(value) == BIGNUM_TYPE) {
+        return value->big;
+    }
+    int64_t n = intValue(value);
+    Bignum view;
+    view.negative = n < 0;
+    buffer[0] = (uint32_t)(n < 0 ? -n : n);
+    view.digits = buffer;
+    view.count = n != 0;
+    return view;
+}
+
+// Allocates room for count digits, all zero.
+uint32_t *newDigits(int count) {
+    return tallocKind(sizeof(uint32_t) * (count > 0 ? count : 1), ATOMIC_KIND);
+}
+
+// Returns the integer with the given sign and the first count digits, some
+// of which may be leading zeros. If it fits, it is a fixnum.
+Value *makeBignum(uint32_t *digits, int count, bool negative) {
+    while (count > 0 && digits[count - 1] == 0) {
+        count--;
+    }
+    if (count == 0) {
+        return makeInt(0);
+    }
+    if (count == 1 && (digits[0] <= 0x7fffffffu || (negative && digits[0] == 0x80000000u))) {
+        int64_t n = digits[0];
+        return makeInt((int)(negative ? -n : n));
+    }
+    Value *value = makeValue(BIGNUM_TYPE);
+    value->big.digits = digits;
+    value->big.count = count;
+    value->big.negative = negative;
+    return value;
+}
+
+// Returns the integer n as a fixnum if it fits, or a bignum.
+Value *makeInteger(int64_t n) {
+    if (n >= INT32_MIN && n <= INT32_MAX) {
+        return makeInt((int)n);
+    }
+    uint64_t magnitude = n < 0 ? -(uint64_t)n : (uint64_t)n;
+    uint32_t *digits = newDigits(2);
+    digits[0] = (uint32_t)magnitude;
+    digits[1] = (uint32_t)(magnitude >> 32);
+    return makeBignum(digits, 2, n < 0);
+}
+
+// Compares two magnitudes, returning -1, 0 or 1.
+int compareDigits(uint32_t *a, int an, uint32_t *b, int bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    for (int i = an - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Sets the first max(an, bn) + 1 digits of out to a + b.
+void addDigits(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *out) {
+    if (an < bn) {
+        uint32_t *digits = a;
+        a = b;
+        b = digits;
+        int count = an;
+        an = bn;
+        bn = count;
+    }
+    uint64_t carry = 0;
+    for (int i = 0; i < bn; i++) {
+        carry += (uint64_t)a[i] + b[i];
+        out[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (int i = bn; i < an; i++) {
+        carry += a[i];
+        out[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    out[an] = (uint32_t)carry;
+}
+
+// Sets the first an digits of out to a - b, which mustn't be negative. out
+// may be a.
+void subtractDigits(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *out) {
+    int64_t borrow = 0;
+    for (int i = 0; i < an; i++) {
+        int64_t difference = (int64_t)a[i] - (i < bn ? b[i] : 0) - borrow;
+        out[i] = (uint32_t)difference;
+        borrow = difference < 0;
+    }
+}
+
+// Adds the sn digits of src into the dn digits of dst, dropping any carry
+// out of them. Digits of src past dn must be zero.
+void addInto(uint32_t *dst, int dn, uint32_t *src, int sn) {
+    uint64_t carry = 0;
+    int i = 0;
+    for (; i < sn && i < dn; i++) {
+        carry += (uint64_t)dst[i] + src[i];
+        dst[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (; carry != 0 && i < dn; i++) {
+        carry += dst[i];
+        dst[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+}
+
+// Multiplies digit by digit, setting the an + bn digits of out to a * b.
+void multiplySchoolbook(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *out) {
+    memset(out, 0, sizeof(uint32_t) * (an + bn));
+    for (int i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < bn; j++) {
+            carry += (uint64_t)a[i] * b[j] + out[i + j];
+            out[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        out[i + bn] = (uint32_t)carry;
+    }
+}
+
+void multiplyDigits(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *out);
+
+// Sets the 2n digits of out to a * b, for two n-digit numbers, by Karatsuba's
+// method: with a = a1 B + a0 and b = b1 B + b0, the product is
+// z2 B^2 + z1 B + z0 where z2 = a1 b1, z0 = a0 b0, and
+// z1 = (a1 + a0)(b1 + b0) - z2 - z0 takes one multiplication rather than two.
+void multiplyKaratsuba(uint32_t *a, uint32_t *b, int n, uint32_t *out) {
+    int low = n / 2;
+    int high = n - low;
+    multiplyDigits(a, low, b, low, out);
+    multiplyDigits(a + low, high, b + low, high, out + 2 * low);
+    uint32_t *scratch = malloc(sizeof(uint32_t) * (4 * high + 4));
+    uint32_t *sumA = scratch;
+    uint32_t *sumB = scratch + high + 1;
+    uint32_t *middle = scratch + 2 * high + 2;
+    addDigits(a + low, high, a, low, sumA);
+    addDigits(b + low, high, b, low, sumB);
+    multiplyDigits(sumA, high + 1, sumB, high + 1, middle);
+    subtractDigits(middle, 2 * high + 2, out, 2 * low, middle);
+    subtractDigits(middle, 2 * high + 2, out + 2 * low, 2 * high, middle);
+    addInto(out + low, 2 * n - low, middle, 2 * high + 2);
+    free(scratch);
+}
+
+// Sets the an + bn digits of out to a * b. Factors of very different lengths
+// are multiplied a piece of the longer one at a time, so that each product
+// Karatsuba's method sees is balanced.
+void multiplyDigits(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *out) {
+    if (an < bn) {
+        uint32_t *digits = a;
+        a = b;
+        b = digits;
+        int count = an;
+        an = bn;
+        bn = count;
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        multiplySchoolbook(a, an, b, bn, out);
+    }
+    else if (an == bn) {
+        multiplyKaratsuba(a, b, an, out);
+    }
+    else {
+        memset(out, 0, sizeof(uint32_t) * (an + bn));
+        uint32_t *piece = malloc(sizeof(uint32_t) * 2 * bn);
+        for (int i = 0; i < an; i += bn) {
+            int count = an - i < bn ? an - i : bn;
+            multiplyDigits(a + i, count, b, bn, piece);
+            addInto(out + i, an + bn - i, piece, count + bn);
+        }
+        free(piece);
+    }
+}
+
+// Divides the an digits of a by the single digit d, setting the an digits of
+// quotient, which may be a, and returning the remainder.
+uint32_t divideBySmall(uint32_t *a, int an, uint32_t d, uint32_t *quotient) {
+    uint64_t remainder = 0;
+    for (int i = an - 1; i >= 0; i--) {
+        uint64_t current = (remainder << 32) | a[i];
+        quotient[i] = (uint32_t)(current / d);
+        remainder = current % d;
+    }
+    return (uint32_t)remainder;
+}
+
+// Divides a by b, which has at least two digits and no more than a, by
+// Knuth's algorithm D. Sets the an - bn + 1 digits of quotient and the bn
+// digits of remainder.
+void divideDigits(uint32_t *a, int an, uint32_t *b, int bn, uint32_t *quotient, uint32_t *remainder) {
+    // Shift both so that the top digit of the divisor has its high bit set,
+    // which keeps each estimate of a quotient digit at most two too big.
+    int shift = __builtin_clz(b[bn - 1]);
+    uint32_t *v = malloc(sizeof(uint32_t) * (an + bn + 1));
+    uint32_t *u = v + bn;
+    for (int i = bn - 1; i > 0; i--) {
+        v[i] = (b[i] << shift) | (shift ? b[i - 1] >> (32 - shift) : 0);
+    }
+    v[0] = b[0] << shift;
+    u[an] = shift ? a[an - 1] >> (32 - shift) : 0;
+    for (int i = an - 1; i > 0; i--) {
+        u[i] = (a[i] << shift) | (shift ? a[i - 1] >> (32 - shift) : 0);
+    }
+    u[0] = a[0] << shift;
+
+    for (int j = an - bn; j >= 0; j--) {
+        uint64_t top = ((uint64_t)u[j + bn] << 32) | u[j + bn - 1];
+        uint64_t estimate = top / v[bn - 1];
+        uint64_t rest = top % v[bn - 1];
+        while (estimate > 0xffffffffu || estimate * v[bn - 2] > ((rest << 32) | u[j + bn - 2])) {
+            estimate--;
+            rest += v[bn - 1];
+            if (rest > 0xffffffffu) {
+                break;
+            }
+        }
+        int64_t borrow = 0;
+        int64_t difference;
+        for (int i = 0; i < bn; i++) {
+            uint64_t product = estimate * v[i];
+            difference = (int64_t)u[i + j] - borrow - (int64_t)(product & 0xffffffffu);
+            u[i + j] = (uint32_t)difference;
+            borrow = (int64_t)(product >> 32) - (difference >> 32);
+        }
+        difference = (int64_t)u[j + bn] - borrow;
+        u[j + bn] = (uint32_t)difference;
+        quotient[j] = (uint32_t)estimate;
+        if (difference < 0) {
+            // The estimate was one too big; add the divisor back.
+            quotient[j]--;
+            uint64_t carry = 0;
+            for (int i = 0; i < bn; i++) {
+                carry += (uint64_t)u[i + j] + v[i];
+                u[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            u[j + bn] += (uint32_t)carry;
+        }
+    }
+    for (int i = 0; i < bn - 1; i++) {
+        remainder[i] = (u[i] >> shift) | (shift ? u[i + 1] << (32 - shift) : 0);
+    }
+    remainder[bn - 1] = u[bn - 1] >> shift;
+    free(v);
+}
+
+// Returns the sum of two integers with the given signs.
+Value *addSigned(Bignum a, Bignum b) {
+    if (a.negative == b.negative) {
+        int count = (a.count > b.count ? a.count : b.count) + 1;
+        uint32_t *digits = newDigits(count);
+        addDigits(a.digits, a.count, b.digits, b.count, digits);
+        return makeBignum(digits, count, a.negative);
+    }
+    if (compareDigits(a.digits, a.count, b.digits, b.count) < 0) {
+        Bignum swap = a;
+        a = b;
+        b = swap;
+    }
+    uint32_t *digits = newDigits(a.count);
+    subtractDigits(a.digits, a.count, b.digits, b.count, digits);
+    return makeBignum(digits, a.count, a.negative);
+}
+
+// Returns a + b for integers that aren't both fixnums whose sum fits in one.
+Value *bignumAdd(Value *a, Value *b) {
+    uint32_t bufferA[1], bufferB[1];
+    return addSigned(viewInteger(a, bufferA), viewInteger(b, bufferB));
+}
+
+// Returns a - b for integers that aren't both fixnums whose difference fits
+// in one.
+Value *bignumSubtract(Value *a, Value *b) {
+    uint32_t bufferA[1], bufferB[1];
+    Bignum negated = viewInteger(b, bufferB);
+    negated.negative = !negated.negative;
+    return addSigned(viewInteger(a, bufferA), negated);
+}
+
+// Returns a * b for integers that aren't both fixnums whose product fits in
+// one.
+Value *bignumMultiply(Value *a, Value *b) {
+    uint32_t bufferA[1], bufferB[1];
+    Bignum x = viewInteger(a, bufferA);
+    Bignum y = viewInteger(b, bufferB);
+    if (x.count == 0 || y.count == 0) {
+        return makeInt(0);
+    }
+    uint32_t *digits = newDigits(x.count + y.count);
+    multiplyDigits(x.digits, x.count, y.digits, y.count, digits);
+    return makeBignum(digits, x.count + y.count, x.negative != y.negative);
+}
+
+// Divides integer a by integer b, which isn't zero, rounding the quotient
+// toward zero. The remainder has the sign of a. Either result pointer may be
+// NULL if that result isn't wanted.
+void integerDivide(Value *a, Value *b, Value **quotient, Value **remainder) {
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE && !(intValue(a) == INT32_MIN && intValue(b) == -1)) {
+        if (quotient != NULL) {
+            *quotient = makeInt(intValue(a) / intValue(b));
+        }
+        if (remainder != NULL) {
+            *remainder = makeInt(intValue(a) % intValue(b));
+        }
+        return;
+    }
+    uint32_t bufferA[1], bufferB[1];
+    Bignum x = viewInteger(a, bufferA);
+    Bignum y = viewInteger(b, bufferB);
+    if (compareDigits(x.digits, x.count, y.digits, y.count) < 0) {
+        if (quotient != NULL) {
+            *quotient = makeInt(0);
+        }
+        if (remainder != NULL) {
+            *remainder = a;
+        }
+        return;
+    }
+    int count = x.count - y.count + 1;
+    uint32_t *quotientDigits = newDigits(count);
+    uint32_t *remainderDigits = newDigits(y.count);
+    if (y.count == 1) {
+        remainderDigits[0] = divideBySmall(x.digits, x.count, y.digits[0], quotientDigits);
+        count = x.count;
+    }
+    else {
+        divideDigits(x.digits, x.count, y.digits, y.count, quotientDigits, remainderDigits);
+    }
+    if (quotient != NULL) {
+        *quotient = makeBignum(quotientDigits, count, x.negative != y.negative);
+    }
+    if (remainder != NULL) {
+        *remainder = makeBignum(remainderDigits, y.count, x.negative);
+    }
+}
+
+// Sets *out to an integer if it fits in an int64_t, and returns whether it
+// did.
+bool integerToInt64(Value *a, int64_t *out) {
+    if (typeOf(a) == INT_TYPE) {
+        *out = intValue(a);
+        return true;
+    }
+    if (a->big.count > 2) {
+        return false;
+    }
+    uint64_t magnitude = a->big.digits[0];
+    if (a->big.count == 2) {
+        magnitude |= (uint64_t)a->big.digits[1] << 32;
+    }
+    if (magnitude > (uint64_t)INT64_MAX + a->big.negative) {
+        return false;
+    }
+    *out = (int64_t)(a->big.negative ? -magnitude : magnitude);
+    return true;
+}
+
+// Returns the greatest common divisor of two magnitudes, or the other one if
+// either is zero. Stein's binary algorithm only shifts and subtracts.
+uint64_t smallGcd(uint64_t a, uint64_t b) {
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t swap = a;
+            a = b;
+            b = swap;
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+// Returns the number of zero bits at the bottom of a nonzero magnitude.
+int trailingZeros(uint32_t *digits) {
+    int i = 0;
+    while (digits[i] == 0) {
+        i++;
+    }
+    return 32 * i + __builtin_ctz(digits[i]);
+}
+
+// Shifts a nonzero magnitude right by the given number of bits, in place,
+// updating its count.
+void shiftRight(uint32_t *digits, int *count, int bits) {
+    int words = bits / 32;
+    bits %= 32;
+    int n = *count - words;
+    for (int i = 0; i < n; i++) {
+        uint32_t high = i + words + 1 < *count ? digits[i + words + 1] : 0;
+        digits[i] = (digits[i + words] >> bits) | (bits ? high << (32 - bits) : 0);
+    }
+    while (n > 0 && digits[n - 1] == 0) {
+        n--;
+    }
+    *count = n;
+}
+
+// Returns the greatest common divisor of two integers, which is never
+// negative. The gcd of 0 and n is |n|. Bignums use the same binary algorithm
+// as smallGcd, on copies of their digits.
+Value *integerGcd(Value *a, Value *b) {
+    uint32_t bufferA[1], bufferB[1];
+    Bignum x = viewInteger(a, bufferA);
+    Bignum y = viewInteger(b, bufferB);
+    if (x.count <= 1 && y.count <= 1) {
+        return makeInteger(smallGcd(x.count ? x.digits[0] : 0, y.count ? y.digits[0] : 0));
+    }
+    if (x.count == 0 || y.count == 0) {
+        Bignum nonzero = x.count ? x : y;
+        return makeBignum(nonzero.digits, nonzero.count, false);
+    }
+    uint32_t *scratch = malloc(sizeof(uint32_t) * (x.count + y.count));
+    uint32_t *u = scratch;
+    uint32_t *v = scratch + x.count;
+    memcpy(u, x.digits, sizeof(uint32_t) * x.count);
+    memcpy(v, y.digits, sizeof(uint32_t) * y.count);
+    int un = x.count;
+    int vn = y.count;
+    int uZeros = trailingZeros(u);
+    int vZeros = trailingZeros(v);
+    int shift = uZeros < vZeros ? uZeros : vZeros;
+    shiftRight(u, &un, uZeros);
+    while (vn > 0) {
+        shiftRight(v, &vn, trailingZeros(v));
+        if (compareDigits(u, un, v, vn) > 0) {
+            uint32_t *digits = u;
+            u = v;
+            v = digits;
+            int count = un;
+            un = vn;
+            vn = count;
+        }
+        subtractDigits(v, vn, u, un, v);
+        while (vn > 0 && v[vn - 1] == 0) {
+            vn--;
+        }
+    }
+    int count = un + shift / 32 + 1;
+    uint32_t *digits = newDigits(count);
+    for (int i = 0; i < un; i++) {
+        uint64_t shifted = (uint64_t)u[i] << (shift % 32);
+        digits[i + shift / 32] |= (uint32_t)shifted;
+        digits[i + shift / 32 + 1] |= (uint32_t)(shifted >> 32);
+    }
+    free(scratch);
+    return makeBignum(digits, count, false);
+}
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b.
+int integerCompare(Value *a, Value *b) {
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE) {
+        return (intValue(a) > intValue(b)) - (intValue(a) < intValue(b));
+    }
+    uint32_t bufferA[1], bufferB[1];
+    Bignum x = viewInteger(a, bufferA);
+    Bignum y = viewInteger(b, bufferB);
+    if (x.negative != y.negative) {
+        return x.negative ? -1 : 1;
+    }
+    int order = compareDigits(x.digits, x.count, y.digits, y.count);
+    return x.negative ? -order : order;
+}
+
+// Returns -1, 0 or 1 as an integer is negative, zero or positive.
+int integerSign(Value *a) {
+    if (typeOf(a) == INT_TYPE) {
+        return (intValue(a) > 0) - (intValue(a) < 0);
+    }
+    return a->big.negative ? -1 : 1;
+}
+
+// Returns the double closest to an integer.
+double integerToDouble(Value *a) {
+    if (typeOf(a) == INT_TYPE) {
+        return intValue(a);
+    }
+    double result = 0;
+    for (int i = a->big.count - 1; i >= 0; i--) {
+        result = result * 4294967296.0 + a->big.digits[i];
+    }
+    return a->big.negative ? -result : result;
+}
+
+// Returns the integer written in decimal in the length characters at digits,
+// which are all digits. Nine decimal digits at a time are multiplied in, and
+// up to nine make a fixnum directly.
+Value *parseInteger(char *digits, int length, bool negative) {
+    if (length <= 9) {
+        int value = 0;
+        for (int i = 0; i < length; i++) {
+            value = value * 10 + (digits[i] - '0');
+        }
+        return makeInt(negative ? -value : value);
+    }
+    int capacity = length / 9 + 2;
+    uint32_t *result = newDigits(capacity);
+    int count = 0;
+    int i = 0;
+    while (i < length) {
+        int chunk = (length - i) % 9 == 0 ? 9 : (length - i) % 9;
+        uint32_t scale = 1;
+        uint32_t value = 0;
+        for (int j = 0; j < chunk; j++) {
+            scale *= 10;
+            value = value * 10 + (digits[i + j] - '0');
+        }
+        uint64_t carry = value;
+        for (int j = 0; j < count; j++) {
+            carry += (uint64_t)result[j] * scale;
+            result[j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            result[count++] = (uint32_t)carry;
+        }
+        i += chunk;
+    }
+    return makeBignum(result, count, negative);
+}
+
+// Prints an integer in decimal, converting it nine digits at a time from the
+// least significant end.
+void printInteger(Value *a) {
+    if (typeOf(a) == INT_TYPE) {
+        printf("%i", intValue(a));
+        return;
+    }
+    int count = a->big.count;
+    uint32_t *digits = malloc(sizeof(uint32_t) * count);
+    memcpy(digits, a->big.digits, sizeof(uint32_t) * count);
+    uint32_t *chunks = malloc(sizeof(uint32_t) * (count * 10 / 9 + 2));
+    int chunkCount = 0;
+    // A bignum has at least one digit, so there is always a chunk to print.
+    do {
+        chunks[chunkCount++] = divideBySmall(digits, count, 1000000000u, digits);
+        while (count > 0 && digits[count - 1] == 0) {
+            count--;
+        }
+    } while (count > 0);
+    if (a->big.negative) {
+        printf("-");
+    }
+    printf("%u", chunks[chunkCount - 1]);
+    for (int i = chunkCount - 2; i >= 0; i--) {
+        printf("%09u", chunks[i]);
+    }
+    free(chunks);
+    free(digits);
+}
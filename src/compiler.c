@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <string.h>
+#include "value.h"
+#include "analyze.h"
+#include "compiler.h"
+#include "talloc.h"
+#include "linkedlist.h"
+
+// Code being compiled, whose arrays grow as instructions are added.
+typedef struct {
+    Code *code;
+    int capacity;
+    int constantCapacity;
+} Compiler;
+
+// Appends an int to the instructions.
+void emit(Compiler *compiler, int op) {
+    Code *code = compiler->code;
+    if (code->length == compiler->capacity) {
+        compiler->capacity *= 2;
+        int *ops = tallocKind(sizeof(int) * compiler->capacity, ATOMIC_KIND);
+        memcpy(ops, code->ops, sizeof(int) * code->length);
+        code->ops = ops;
+    }
+    code->ops[code->length++] = op;
+}
+
+// Adds a constant and returns its index.
+int addConstant(Compiler *compiler, void *constant) {
+    Code *code = compiler->code;
+    if (code->constantCount == compiler->constantCapacity) {
+        compiler->constantCapacity *= 2;
+        void **constants = talloc(sizeof(void *) * compiler->constantCapacity);
+        memcpy(constants, code->constants, sizeof(void *) * code->constantCount);
+        code->constants = constants;
+    }
+    code->constants[code->constantCount] = constant;
+    return code->constantCount++;
+}
+
+// Appends an instruction whose operand is a constant.
+void emitConstant(Compiler *compiler, opcode op, void *constant) {
+    emit(compiler, op);
+    emit(compiler, addConstant(compiler, constant));
+}
+
+// Appends a jump whose target isn't known yet, and returns where to patch it
+// in once it is.
+int emitJump(Compiler *compiler, opcode op) {
+    emit(compiler, op);
+    emit(compiler, -1);
+    return compiler->code->length - 1;
+}
+
+// Appends a conditional jump that checks the popped value is a boolean.
+int emitTest(Compiler *compiler, testKind test) {
+    int patch = emitJump(compiler, JUMP_IF_FALSE_OP);
+    emit(compiler, test);
+    return patch;
+}
+
+// Makes a jump emitted earlier go to the next instruction.
+void patchJump(Compiler *compiler, int patch) {
+    compiler->code->ops[patch] = compiler->code->length;
+}
+
+void compileNode(Compiler *compiler, Node *node, bool tail);
+
+// Compiles expressions in turn, keeping only the last value. The last is in
+// tail position if the sequence is.
+void compileSequence(Compiler *compiler, int count, Node **items, bool tail) {
+    if (count == 0) {
+        emitConstant(compiler, CONSTANT_OP, VOID_VALUE);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            emit(compiler, POP_OP);
+        }
+        compileNode(compiler, items[i], tail && i == count - 1);
+    }
+}
+
+// Compiles an if, or a when or unless, whose missing branch gives null.
+void compileBranch(Compiler *compiler, Node *then, Node *otherwise, bool tail) {
+    int elsePatch = emitTest(compiler, IF_TEST);
+    if (then != NULL) {
+        compileNode(compiler, then, tail);
+    }
+    else {
+        emitConstant(compiler, CONSTANT_OP, makeNull());
+    }
+    int endPatch = emitJump(compiler, JUMP_OP);
+    patchJump(compiler, elsePatch);
+    if (otherwise != NULL) {
+        compileNode(compiler, otherwise, tail);
+    }
+    else {
+        emitConstant(compiler, CONSTANT_OP, makeNull());
+    }
+    patchJump(compiler, endPatch);
+}
+
+// Compiles the clauses of a cond. Every clause that is taken jumps to the end.
+void compileCond(Compiler *compiler, Node *node, bool tail) {
+    int *endPatches = talloc(sizeof(int) * node->seq.count);
+    int clauses = 0;
+    bool hasElse = false;
+    for (int i = 0; i < node->seq.count && !hasElse; i++) {
+        if (node->seq.tests[i] == NULL) {
+            compileNode(compiler, node->seq.items[i], tail);
+            hasElse = true;
+            continue;
+        }
+        compileNode(compiler, node->seq.tests[i], false);
+        int nextPatch = emitTest(compiler, COND_TEST);
+        compileNode(compiler, node->seq.items[i], tail);
+        endPatches[clauses++] = emitJump(compiler, JUMP_OP);
+        patchJump(compiler, nextPatch);
+    }
+    if (!hasElse) {
+        emitConstant(compiler, CONSTANT_OP, VOID_VALUE);
+    }
+    for (int i = 0; i < clauses; i++) {
+        patchJump(compiler, endPatches[i]);
+    }
+}
+
+// Compiles an and, or an or. Each argument that decides the result jumps to
+// where that result is pushed.
+void compileLogic(Compiler *compiler, Node *node, bool isAnd) {
+    int *patches = talloc(sizeof(int) * node->seq.count);
+    for (int i = 0; i < node->seq.count; i++) {
+        compileNode(compiler, node->seq.items[i], false);
+        if (isAnd) {
+            patches[i] = emitTest(compiler, AND_TEST);
+        }
+        else {
+            int nextPatch = emitTest(compiler, AND_TEST);
+            patches[i] = emitJump(compiler, JUMP_OP);
+            patchJump(compiler, nextPatch);
+        }
+    }
+    emitConstant(compiler, CONSTANT_OP, makeBool(isAnd));
+    int endPatch = emitJump(compiler, JUMP_OP);
+    for (int i = 0; i < node->seq.count; i++) {
+        patchJump(compiler, patches[i]);
+    }
+    emitConstant(compiler, CONSTANT_OP, makeBool(!isAnd));
+    patchJump(compiler, endPatch);
+}
+
+// Compiles a let, let* or letrec. The new frame is entered once the values of
+// a let are on the stack, but before those of a let* or letrec are computed.
+void compileLet(Compiler *compiler, Node *node, bool tail) {
+    int count = node->let.count;
+    if (node->kind == LET_NODE) {
+        for (int i = 0; i < count; i++) {
+            compileNode(compiler, node->let.inits[i], false);
+        }
+        emit(compiler, FRAME_OP);
+        emit(compiler, node->let.slots);
+        emit(compiler, node->let.escapes);
+        for (int i = count - 1; i >= 0; i--) {
+            emit(compiler, BIND_OP);
+            emit(compiler, i);
+        }
+    }
+    else {
+        emit(compiler, FRAME_OP);
+        emit(compiler, node->let.slots);
+        emit(compiler, node->let.escapes);
+        for (int i = 0; i < count; i++) {
+            compileNode(compiler, node->let.inits[i], false);
+            emit(compiler, BIND_OP);
+            emit(compiler, i);
+        }
+    }
+    compileNode(compiler, node->let.body, tail);
+    emit(compiler, LEAVE_OP);
+}
+
+// Appends the instructions that push the value of a node. A node is in tail
+// position when nothing but leaving frames and returning follows it, so a
+// call there can replace the current one.
+void compileNode(Compiler *compiler, Node *node, bool tail) {
+    switch (node->kind) {
+        case CONSTANT_NODE:
+            emitConstant(compiler, CONSTANT_OP, node->value);
+            break;
+        case VARIABLE_NODE:
+            if (node->var.depth < 0) {
+                emitConstant(compiler, GLOBAL_OP, node->var.global);
+            }
+            else {
+                emitConstant(compiler, LOCAL_OP, node);
+            }
+            break;
+        case IF_NODE:
+            compileNode(compiler, node->branch.test, false);
+            compileBranch(compiler, node->branch.then, node->branch.otherwise, tail);
+            break;
+        case WHEN_NODE:
+            compileNode(compiler, node->branch.test, false);
+            compileBranch(compiler, node->branch.then, NULL, tail);
+            break;
+        case UNLESS_NODE:
+            compileNode(compiler, node->branch.test, false);
+            compileBranch(compiler, NULL, node->branch.then, tail);
+            break;
+        case COND_NODE:
+            compileCond(compiler, node, tail);
+            break;
+        case BEGIN_NODE:
+            compileSequence(compiler, node->seq.count, node->seq.items, tail);
+            break;
+        case AND_NODE:
+            compileLogic(compiler, node, true);
+            break;
+        case OR_NODE:
+            compileLogic(compiler, node, false);
+            break;
+        case LET_NODE:
+        case LET_STAR_NODE:
+        case LETREC_NODE:
+            compileLet(compiler, node, tail);
+            break;
+        case LAMBDA_NODE:
+            emitConstant(compiler, CLOSURE_OP, node);
+            break;
+        case DEFINE_NODE:
+            compileNode(compiler, node->var.value, false);
+            if (node->var.depth < 0) {
+                emitConstant(compiler, DEFINE_GLOBAL_OP, node->var.global);
+            }
+            else {
+                emit(compiler, BIND_OP);
+                emit(compiler, node->var.index);
+            }
+            emitConstant(compiler, CONSTANT_OP, VOID_VALUE);
+            break;
+        case SET_NODE:
+            compileNode(compiler, node->var.value, false);
+            if (node->var.depth < 0) {
+                emitConstant(compiler, SET_GLOBAL_OP, node->var.global);
+            }
+            else {
+                emitConstant(compiler, SET_LOCAL_OP, node);
+            }
+            emitConstant(compiler, CONSTANT_OP, VOID_VALUE);
+            break;
+        case DISPLAY_NODE:
+            compileNode(compiler, node->var.value, false);
+            emit(compiler, DISPLAY_OP);
+            break;
+        case APPLICATION_NODE:
+            compileNode(compiler, node->app.operator, false);
+            for (int i = 0; i < node->app.count; i++) {
+                compileNode(compiler, node->app.args[i], false);
+            }
+            emit(compiler, tail ? TAIL_CALL_OP : CALL_OP);
+            emit(compiler, node->app.count);
+            break;
+    }
+}
+
+// Compiles an analyzed expression into code that returns its value.
+Code *compile(Node *node) {
+    Compiler compiler;
+    compiler.capacity = 16;
+    compiler.constantCapacity = 4;
+    compiler.code = talloc(sizeof(Code));
+    compiler.code->ops = tallocKind(sizeof(int) * compiler.capacity, ATOMIC_KIND);
+    compiler.code->constants = talloc(sizeof(void *) * compiler.constantCapacity);
+    compileNode(&compiler, node, true);
+    emit(&compiler, RETURN_OP);
+    return compiler.code;
+}
+
+// Returns the code for the body of a lambda node, compiling it the first
+// time it is asked for.
+Code *compileLambda(Node *lambda) {
+    if (lambda->let.code == NULL) {
+        lambda->let.code = compile(lambda->let.body);
+    }
+    return lambda->let.code;
+}
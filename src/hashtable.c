@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <string.h>
+#include "value.h"
+#include "hashtable.h"
+#include "interpreter.h"
+#include "linkedlist.h"
+#include "parser.h"
+#include "talloc.h"
+
+// Hash tables use open addressing with linear probing, kept in Robin Hood
+// order: no entry is further from the slot its hash starts at than the
+// entries it passed on the way there. So a lookup can give up as soon as it
+// reaches an entry closer to its own start than the key would be, and
+// removing an entry shifts the ones after it back rather than leaving a
+// tombstone. Each entry keeps its key's hash, so growing the table never
+// rehashes a key and probing rarely has to compare two.
+//
+// An eq? table can't hash a boxed key by its address, which changes when the
+// collector moves it, so a key is given an identity number the first time it
+// is hashed. An equal? table hashes a key's contents, so that equal? keys
+// hash the same; only the first HASH_BUDGET Values of a list or vector are
+// hashed, which bounds the time taken on big keys.
+
+#define HASH_BUDGET 32
+#define MIN_SIZE_LOG 3
+
+// The number of identity numbers given out so far.
+uint64_t identityCount = 0;
+
+// Scrambles the bits of a word into a 32-bit hash.
+uint32_t mixBits(uint64_t bits) {
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    bits *= 0xc4ceb9fe1a85ec53ULL;
+    bits ^= bits >> 33;
+    return (uint32_t)bits;
+}
+
+// Folds hash into seed, the hash of what came before it.
+uint32_t combineHashes(uint32_t seed, uint32_t hash) {
+    return seed ^ (hash + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+}
+
+// FNV-1a hash of size bytes.
+uint32_t hashBytes(void *bytes, size_t size) {
+    unsigned char *byte = bytes;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ byte[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash of a double. 0.0 and -0.0 are equal?, so they hash the same.
+uint32_t hashDouble(double d) {
+    uint64_t bits = 0;
+    if (d != 0) {
+        memcpy(&bits, &d, sizeof(double));
+    }
+    return mixBits(bits);
+}
+
+// Returns the eq? hash of a Value: its bits for an immediate, and otherwise
+// its identity number.
+uint32_t identityHash(Value *value) {
+    if (isImmediate(value)) {
+        return mixBits((uintptr_t)value);
+    }
+    if (value->identity == 0) {
+        value->identity = mixBits(++identityCount) | 1;
+    }
+    return value->identity;
+}
+
+// Returns the equal? hash of a Value. budget is the number of Values that may
+// still be hashed; once it runs out every Value hashes to 0.
+uint32_t equalHash(Value *value, int *budget) {
+    if (--*budget < 0) {
+        return 0;
+    }
+    switch (typeOf(value)) {
+        case DOUBLE_TYPE:
+            return hashDouble(value->d);
+        case BIGNUM_TYPE:
+            return hashBytes(value->big.digits, sizeof(uint32_t) * value->big.count) +
+                value->big.negative;
+        case RATIONAL_TYPE:
+            return combineHashes(equalHash(value->rat.numerator, budget),
+                                 equalHash(value->rat.denominator, budget));
+        case STR_TYPE:
+            return value->str.hash;
+        case SINGLE_QUOTE_TYPE:
+            return hashBytes(value->s, strlen(value->s));
+        case F64VECTOR_TYPE: {
+            double *elements = value->nv.elements;
+            uint32_t hash = mixBits(value->nv.count);
+            for (int64_t i = 0; i < value->nv.count && i < HASH_BUDGET; i++) {
+                hash = combineHashes(hash, hashDouble(elements[i]));
+            }
+            return hash;
+        }
+        case S64VECTOR_TYPE: {
+            int64_t *elements = value->nv.elements;
+            uint32_t hash = mixBits(value->nv.count);
+            for (int64_t i = 0; i < value->nv.count && i < HASH_BUDGET; i++) {
+                hash = combineHashes(hash, mixBits(elements[i]));
+            }
+            return hash;
+        }
+        case VECTOR_TYPE: {
+            uint32_t hash = mixBits(value->vec.count);
+            for (int64_t i = 0; i < value->vec.count && *budget > 0; i++) {
+                hash = combineHashes(hash, equalHash(value->vec.items[i], budget));
+            }
+            return hash;
+        }
+        case CONS_TYPE: {
+            uint32_t hash = 0;
+            while (typeOf(value) == CONS_TYPE && *budget > 0) {
+                hash = combineHashes(hash, equalHash(car(value), budget));
+                value = cdr(value);
+            }
+            return combineHashes(hash, equalHash(value, budget));
+        }
+        default:
+            // Anything else is only equal? to itself; symbols are interned.
+            return identityHash(value);
+    }
+}
+
+// Returns the hash of a key in a hash table, which fits in a fixnum.
+uint32_t hashKey(Value *table, Value *key) {
+    int budget = HASH_BUDGET;
+    uint32_t hash = table->ht.equal ? equalHash(key, &budget) : identityHash(key);
+    return hash & 0x7fffffff;
+}
+
+// Returns the index of the entry for key in a hash table, or -1 if there is
+// none. hash is the key's hash.
+int64_t findEntry(Value *table, Value *key, uint32_t hash) {
+    uint32_t mask = (1u << table->ht.sizeLog) - 1;
+    uint32_t i = hash & mask;
+    for (uint32_t distance = 0; ; distance++) {
+        // Comparing keys may collect, so the slots are looked up each time.
+        Value **entry = table->ht.slots + 3 * i;
+        if (entry[0] == NULL) {
+            return -1;
+        }
+        uint32_t theirs = (uint32_t)intValue(entry[0]);
+        if (((i - theirs) & mask) < distance) {
+            return -1;
+        }
+        if (theirs == hash && (entry[1] == key ||
+                               (table->ht.equal && valuesEqual(entry[1], key)))) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+// Puts an entry for a key that isn't there yet into the slots of a table with
+// mask + 1 entries. On the way it takes the place of any entry closer to its
+// start than the one being put is, which then moves on in its place.
+void placeEntry(Value **slots, uint32_t mask, Value *hash, Value *key, Value *value) {
+    uint32_t i = (uint32_t)intValue(hash) & mask;
+    uint32_t distance = 0;
+    while (slots[3 * i] != NULL) {
+        uint32_t theirs = (i - (uint32_t)intValue(slots[3 * i])) & mask;
+        if (theirs < distance) {
+            Value *entry[3] = {hash, key, value};
+            hash = slots[3 * i];
+            key = slots[3 * i + 1];
+            value = slots[3 * i + 2];
+            memcpy(slots + 3 * i, entry, sizeof(entry));
+            distance = theirs;
+        }
+        i = (i + 1) & mask;
+        distance++;
+    }
+    slots[3 * i] = hash;
+    slots[3 * i + 1] = key;
+    slots[3 * i + 2] = value;
+}
+
+// Doubles the number of entries in a hash table, moving what it holds into a
+// new slots array.
+void growHashTable(Value *table) {
+    int sizeLog = table->ht.sizeLog + 1;
+    Value **slots = tallocKind((sizeof(Value *) * 3) << sizeLog, ARRAY_KIND);
+    Value **old = table->ht.slots;
+    uint32_t mask = (1u << sizeLog) - 1;
+    for (uint32_t i = 0; i < 1u << table->ht.sizeLog; i++) {
+        if (old[3 * i] != NULL) {
+            placeEntry(slots, mask, old[3 * i], old[3 * i + 1], old[3 * i + 2]);
+        }
+    }
+    table->ht.slots = slots;
+    table->ht.sizeLog = sizeLog;
+    tbarrier(table);
+}
+
+// Returns a new, empty hash table. Its keys are compared with equal? if equal
+// is set, and with eq? otherwise.
+Value *makeHashTable(bool equal) {
+    Value **slots = tallocKind((sizeof(Value *) * 3) << MIN_SIZE_LOG, ARRAY_KIND);
+    Value *table = makeValue(HASH_TABLE_TYPE);
+    table->ht.slots = slots;
+    table->ht.count = 0;
+    table->ht.sizeLog = MIN_SIZE_LOG;
+    table->ht.equal = equal;
+    return table;
+}
+
+// Returns the value that key maps to in a hash table, or NULL if it has none.
+Value *hashTableRef(Value *table, Value *key) {
+    int64_t i = findEntry(table, key, hashKey(table, key));
+    return i < 0 ? NULL : table->ht.slots[3 * i + 2];
+}
+
+// Maps key to value in a hash table, replacing any value it had. The table
+// grows once it would be more than 4/5 full.
+void hashTableSet(Value *table, Value *key, Value *value) {
+    uint32_t hash = hashKey(table, key);
+    int64_t i = findEntry(table, key, hash);
+    if (i >= 0) {
+        table->ht.slots[3 * i + 2] = value;
+        tbarrier(table->ht.slots);
+        return;
+    }
+    if ((int64_t)(table->ht.count + 1) * 5 > (int64_t)4 << table->ht.sizeLog) {
+        growHashTable(table);
+    }
+    placeEntry(table->ht.slots, (1u << table->ht.sizeLog) - 1, makeInt(hash), key, value);
+    table->ht.count++;
+    tbarrier(table->ht.slots);
+}
+
+// Removes key from a hash table. Returns whether it was there. The entries
+// after it that aren't at their start move back one slot, up to an empty
+// slot or one that is.
+bool hashTableRemove(Value *table, Value *key) {
+    int64_t found = findEntry(table, key, hashKey(table, key));
+    if (found < 0) {
+        return false;
+    }
+    Value **slots = table->ht.slots;
+    uint32_t mask = (1u << table->ht.sizeLog) - 1;
+    uint32_t i = found;
+    uint32_t next = (i + 1) & mask;
+    while (slots[3 * next] != NULL && ((next - (uint32_t)intValue(slots[3 * next])) & mask) != 0) {
+        memcpy(slots + 3 * i, slots + 3 * next, sizeof(Value *) * 3);
+        i = next;
+        next = (next + 1) & mask;
+    }
+    slots[3 * i] = NULL;
+    slots[3 * i + 1] = NULL;
+    slots[3 * i + 2] = NULL;
+    table->ht.count--;
+    return true;
+}
+
+// Exits unless value is a hash table.
+void checkIsHashTable(char *name, Value *value) {
+    if (typeOf(value) != HASH_TABLE_TYPE) {
+        printf("%s: contract violation\n"
+               "  expected: hash-table?", name);
+        texit(1);
+    }
+}
+
+// Primitive function for making a hash table. Keys are compared with equal?,
+// or with eq? if that is the argument.
+Value *primitiveMakeHashTable(int argc, Value **argv) {
+    if (argc == 0) {
+        return makeHashTable(true);
+    }
+    if (typeOf(argv[0]) == PRIMITIVE_TYPE) {
+        if (argv[0]->prim->function == primitiveEqual) {
+            return makeHashTable(true);
+        }
+        if (argv[0]->prim->function == primitiveEq) {
+            return makeHashTable(false);
+        }
+    }
+    printf("make-hash-table: contract violation\n"
+           "  expected: (or/c eq? equal?)");
+    texit(1);
+    return NULL;
+}
+
+// Primitive function for whether its argument is a hash table.
+Value *primitiveIsHashTable(int argc, Value **argv) {
+    return makeBool(typeOf(argv[0]) == HASH_TABLE_TYPE);
+}
+
+// Primitive function for the value a key maps to in a hash table. If it has
+// none, returns the third argument, or exits if there isn't one.
+Value *primitiveHashRef(int argc, Value **argv) {
+    checkIsHashTable("hash-ref", argv[0]);
+    Value *value = hashTableRef(argv[0], argv[1]);
+    if (value != NULL) {
+        return value;
+    }
+    if (argc == 3) {
+        return argv[2];
+    }
+    printf("hash-ref: no value found for key\n"
+           "  key: ");
+    printTree(argv[1]);
+    texit(1);
+    return NULL;
+}
+
+// Primitive function for whether a hash table has a value for a key.
+Value *primitiveHashHasKey(int argc, Value **argv) {
+    checkIsHashTable("hash-has-key?", argv[0]);
+    return makeBool(hashTableRef(argv[0], argv[1]) != NULL);
+}
+
+// Primitive function for mapping a key to a value in a hash table.
+Value *primitiveHashSet(int argc, Value **argv) {
+    checkIsHashTable("hash-set!", argv[0]);
+    hashTableSet(argv[0], argv[1], argv[2]);
+    return VOID_VALUE;
+}
+
+// Primitive function for removing a key from a hash table, if it is there.
+Value *primitiveHashRemove(int argc, Value **argv) {
+    checkIsHashTable("hash-remove!", argv[0]);
+    hashTableRemove(argv[0], argv[1]);
+    return VOID_VALUE;
+}
+
+// Primitive function for the number of keys in a hash table.
+Value *primitiveHashCount(int argc, Value **argv) {
+    checkIsHashTable("hash-count", argv[0]);
+    return makeInt(argv[0]->ht.count);
+}
+
+// Returns a list with an item for each entry of a hash table: its key if part
+// is 1, its value if part is 2, or a pair of both if part is 0. The list is
+// built from the last entry back, rereading the slots after every cons, which
+// may collect.
+Value *hashTableEntries(Value *table, int part) {
+    Value *list = makeNull();
+    for (int64_t i = ((int64_t)1 << table->ht.sizeLog) - 1; i >= 0; i--) {
+        Value **entry = table->ht.slots + 3 * i;
+        if (entry[0] == NULL) {
+            continue;
+        }
+        Value *item = part == 0 ? cons(entry[1], entry[2]) : entry[part];
+        list = cons(item, list);
+    }
+    return list;
+}
+
+// Primitive function for a list of the keys of a hash table.
+Value *primitiveHashKeys(int argc, Value **argv) {
+    checkIsHashTable("hash-keys", argv[0]);
+    return hashTableEntries(argv[0], 1);
+}
+
+// Primitive function for a list of the values in a hash table.
+Value *primitiveHashValues(int argc, Value **argv) {
+    checkIsHashTable("hash-values", argv[0]);
+    return hashTableEntries(argv[0], 2);
+}
+
+// Primitive function for a list of the (key . value) pairs in a hash table.
+Value *primitiveHashToList(int argc, Value **argv) {
+    checkIsHashTable("hash->list", argv[0]);
+    return hashTableEntries(argv[0], 0);
+}
+
+// Binds the hash table primitives as global variables.
+void bindHashTables() {
+    bind("make-hash-table", primitiveMakeHashTable, 0, 1);
+    bind("hash-table?", primitiveIsHashTable, 1, 1);
+    bind("hash-ref", primitiveHashRef, 2, 3);
+    bind("hash-has-key?", primitiveHashHasKey, 2, 2);
+    bind("hash-set!", primitiveHashSet, 3, 3);
+    bind("hash-remove!", primitiveHashRemove, 2, 2);
+    bind("hash-count", primitiveHashCount, 1, 1);
+    bind("hash-keys", primitiveHashKeys, 1, 1);
+    bind("hash-values", primitiveHashValues, 1, 1);
+    bind("hash->list", primitiveHashToList, 1, 1);
+}
+
+// Prints a hash table, as #hash((key . value) ...) or #hasheq(...).
+void printHashTable(Value *table) {
+    printf(table->ht.equal ? "#hash(" : "#hasheq(");
+    bool first = true;
+    for (int64_t i = 0; i < (int64_t)1 << table->ht.sizeLog; i++) {
+        Value **entry = table->ht.slots + 3 * i;
+        if (entry[0] == NULL) {
+            continue;
+        }
+        if (!first) {
+            printf(" ");
+        }
+        first = false;
+        printf("(");
+        printTree(entry[1]);
+        printf(" . ");
+        printTree(table->ht.slots[3 * i + 2]);
+        printf(")");
+    }
+    printf(")");
+}
@@ -7,819 +7,267 @@
 #include "linkedlist.h"
 #include "tokenizer.h"
 #include "parser.h"
-
-
-// Checks for the value of a symbol if it has been defined in the current frame
-// Returns error if undefined so far
-Value *lookUpSymbol(Value *symbol, Frame *frame) {
-    Value *current = frame->bindings;
-    while (current->type != NULL_TYPE) {
-        Value *param1 = car(car(current));
-        Value *bind1 = car(cdr(car(current)));
-        if (!strcmp(param1->s, symbol->s)) {
-            return bind1;
-        }
-        current = cdr(current);
-    }
-    if (frame->parent != NULL){
-        return lookUpSymbol(symbol, frame->parent);
-    }
-    else {
-        printf("%s: undefined; cannot reference an identifier before its definition", symbol->s);
-        texit(1);
-    }
-    return symbol;
-}
-
-// Checks if a symbol has already been defined, to prevent duplicates.
-bool symbolDefined(Value *symbol, Value *bindings) {
-    Value *current = bindings;
-    while (current->type != NULL_TYPE) {
-        if (!strcmp(car(car(current))->s, symbol->s)) {
-            return true;
-        }
-        current = cdr(current);
-    }
-    return false;
-}
-
-// Evaluates the arguments of an if statement.
-// If true, returns first arg
-// If false, returns second arg
-Value *evalIf(Value *args, Frame *frame) {
-    if (length(args) != 3) {
-        printf("if: bad syntax in if");
-        texit(1);
-    }
-    Value *condition = eval(car(args), frame);
-    if(condition->type != BOOL_TYPE) {
-        printf("Evaluation Error");
-        texit(1);
-    }
-    Value *first = car(cdr(args));
-    Value *second = car(cdr(cdr(args)));
-    if (!strcmp(condition->s, "#t")) {
-        return eval(first, frame);
-    }
-    else {
-        return eval(second, frame);
-    }
-}
-
-// Takes multiple condition, expression pairs. Return first expression whose condition is true, or the default.
-Value *evalCond(Value *args, Frame *frame) {
-    Value *current = args;
-    while(current->type != NULL_TYPE) {
-        Value *arg = car(current);
-        if(length(arg) != 2) {
-            printf("cond: error...");
-            texit(1);
-        }
-        if(car(arg)->type == SYMBOL_TYPE && !strcmp(car(arg)->s, "else")) {
-            return eval(car(cdr(arg)), frame);
-        }
-        Value *condition = eval(car(arg), frame);
-        Value *expr = eval(car(cdr(arg)), frame);
-        if(condition->type != BOOL_TYPE) {
-            printf("cond: argument not boolean");
-            texit(1);
-        }
-        if(!strcmp(condition->s, "#f")) {
-            current = cdr(current);
-        }
-        else {
-            return expr;
-        }
-    }
-    Value *v = makeNull();
-    v->type = VOID_TYPE;
-    return v;
-}
-
-// Take a bound variable, rebinds it to a new expression
-Value *evalSet(Value* args, Frame *frame) {
-    if (length(args) != 2) {
-        printf(" set!: bad syntax ");
-        texit(1);
-    }
-
-    Value *v = makeNull();
-    v->type = VOID_TYPE;
-
-    Value *var = car(args);
-    Value *expr = eval(car(cdr(args)), frame);
-    Value *bindings = frame->bindings;
-
-    while (bindings->type != NULL_TYPE) {
-        Value *param1 = car(car(bindings));
-        if (!strcmp(param1->s, var->s)) {
-            car(bindings)->c.cdr = cons(expr, makeNull());
-            return v;
-        }
-        bindings = cdr(bindings);
-    }
-    if (frame->parent != NULL){
-        return evalSet(args, frame->parent);
-    }
-    else {
-        printf("%s: undefined; cannot reference an identifier before its definition", var->s);
-        texit(1);
-        return v;
-    }
-}
-
-// Evaluates the arguments of a let statement
-// Creates a set of bindings, evaluates the al other arguments
-// Returns the last argument
-Value *evalLet(Value* args, Frame *frame) {
-    if (length(args) < 2) {
-        printf("let: bad syntax (missing binding pairs or body)");
-        texit(1);
-    }
-    Frame *newFrame = talloc(sizeof(Frame));
-    newFrame->parent = frame;
-    newFrame->bindings = makeNull();
-
-    Value *letBindings = car(args);
-    Value *body = cdr(args);
-
-    Value *current = letBindings;
-    while(current->type != NULL_TYPE) {
-        Value *binding = car(current);
-        if(length(binding) == 2 && car(binding)->type == SYMBOL_TYPE) {
-            if (symbolDefined(car(binding), newFrame->bindings)) {
-                printf("let: duplicate identifier in: %s", car(binding)->s);
-                texit(1);
-            }
-            if (car(cdr(binding))->type == SYMBOL_TYPE || car(cdr(binding))->type == CONS_TYPE) {
-                Value *test = cons(eval(car(cdr(binding)), frame), makeNull());
-                binding = cons(car(binding), test);
-            }
-            newFrame->bindings = cons(binding, newFrame->bindings);
-            current = cdr(current);
-        }
-        else {
-            printf("let: bad syntax (not an identifier)");
-            texit(1);
-        }
-    }
-    Value *result = makeNull();
-    while (body->type != NULL_TYPE) {
-        result = eval(car(body), newFrame);
-        body = cdr(body);
-    }
-    return result;
-}
-
-// Evaluates the val-exprs one by one, creating a location for each id as soon as the value is available.
-Value *evalLetStar(Value *args, Frame *frame) {
-    if (length(args) < 2) {
-        printf("let*: bad syntax (missing binding pairs or body)");
-        texit(1);
-    }
-    Frame *newFrame = talloc(sizeof(Frame));
-    newFrame->parent = frame;
-    newFrame->bindings = makeNull();
-
-    Value *letBindings = car(args);
-    Value *body = cdr(args);
-
-    Value *current = letBindings;
-    while(current->type != NULL_TYPE) {
-        Value *binding = car(current);
-        if(length(binding) == 2 && car(binding)->type == SYMBOL_TYPE) {
-            if (symbolDefined(car(binding), newFrame->bindings)) {
-                printf("let*: duplicate identifier in: %s", car(binding)->s);
-                texit(1);
-            }
-            if (car(cdr(binding))->type == SYMBOL_TYPE || car(cdr(binding))->type == CONS_TYPE) {
-                Value *test = cons(eval(car(cdr(binding)), newFrame), makeNull());
-                binding = cons(car(binding), test);
-            }
-            newFrame->bindings = cons(binding, newFrame->bindings);
-            current = cdr(current);
-        }
-        else {
-            printf("let*: bad syntax (not an identifier)");
-            texit(1);
-        }
-    }
-    Value *result = makeNull();
-    while (body->type != NULL_TYPE) {
-        result = eval(car(body), newFrame);
-        body = cdr(body);
-    }
-    return result;
-}
-
-
-//Like let, including left-to-right evaluation of the val-exprs,
-// but the locations for all ids are created first, all ids are bound in all val-exprs as well as the bodys,
-// and each id is initialized immediately after the corresponding val-expr is evaluated.
-Value *evalLetRec(Value *args, Frame *frame) {
-    if (length(args) < 2) {
-        printf("letrec: bad syntax (missing binding pairs or body)");
-        texit(1);
-    }
-    Frame *newFrame = talloc(sizeof(Frame));
-    newFrame->parent = frame;
-    newFrame->bindings = makeNull();
-
-    Value *letBindings = car(args);
-    Value *body = cdr(args);
-
-    Value *current = letBindings;
-    while(current->type != NULL_TYPE) {
-        Value *binding = car(current);
-        if(length(binding) == 2 && car(binding)->type == SYMBOL_TYPE) {
-            if (symbolDefined(car(binding), newFrame->bindings)) {
-                printf("letrec: duplicate identifier in: %s", car(binding)->s);
-                texit(1);
-            }
-            if (car(cdr(binding))->type == SYMBOL_TYPE || car(cdr(binding))->type == CONS_TYPE) {
-                //Value *test = cons(eval(car(cdr(binding)), newFrame), makeNull());
-                binding = cons(car(binding), cons(makeNull(), makeNull()));
-            }
-            newFrame->bindings = cons(binding, newFrame->bindings);
-            current = cdr(current);
-        }
-        else {
-            printf("letrec: bad syntax (not an identifier)");
-            texit(1);
-        }
-    }
-    current = letBindings;
-    while(current->type != NULL_TYPE) {
-        Value *binding = car(current);
-        evalSet(binding, newFrame);
-        current = cdr(current);
-    }
-    Value *result = makeNull();
-    while (body->type != NULL_TYPE) {
-        result = eval(car(body), newFrame);
-        body = cdr(body);
-    }
-    return result;
-}
-
-
-// Evaluates all expressions, returns the last one
-Value *evalBegin(Value* args, Frame *frame) {
-    Value *whenArgs = args;
-    Value *result = makeNull();
-    result->type = VOID_TYPE;
-
-    while (whenArgs->type != NULL_TYPE) {
-        result = eval(car(whenArgs),  frame);
-        whenArgs = cdr(whenArgs);
-    }
-    return result;
-}
-
-// Evaluates arguments of a when statement
-// If true, evaluates all and returns the last
-// If false, returns null
-Value *evalWhen(Value* args, Frame *frame) {
-    Value *condition = eval(car(args), frame);
-    if(condition->type != BOOL_TYPE) {
-        printf("Evaluation Error");
-        texit(1);
-    }
-    Value *result = makeNull();
-    if(!strcmp(condition->s, "#f")) {
-        return result;
-
-    }
-    Value *whenArgs = cdr(args);
-    while (whenArgs->type != NULL_TYPE) {
-        result = eval(car(whenArgs),  frame);
-        whenArgs = cdr(whenArgs);
-    }
-    return result;
-}
-
-// Evaluates arguments of an unless statement
-// If false, evaluates all and returns the last
-// If true, returns null
-Value *evalUnless(Value* args, Frame *frame) {
-    Value *condition = eval(car(args), frame);
-    if(condition->type != BOOL_TYPE) {
-        printf("Evaluation Error");
-        texit(1);
-    }
-    Value *result = makeNull();
-    if(!strcmp(condition->s, "#t")) {
-        return result;
-
-    }
-    Value *whenArgs = cdr(args);
-    while (whenArgs->type != NULL_TYPE) {
-        result = eval(car(whenArgs),  frame);
-        whenArgs = cdr(whenArgs);
-    }
-    return result;
-}
-
-// Evaluates argument of a display statement
-// Returns the value to be displayed
-Value *evalDisplay(Value *args, Frame *frame) {
-    if(length(args) != 1) {
-        printf("display: arity mismatch;\n"
-               " the expected number of arguments does not match the given number.");
-        texit(1);
-    }
-    Value *arg = car(args);
-    Value *new = makeNull();
-    new->type = VOID_TYPE;
-    if (arg->type == STR_TYPE) {
-        char *newString = talloc(sizeof(char[255]));
-        newString[0] = '\0';
-        if (arg->s[1] == '"') {
-            newString = "\0";
-        }
-        else {
-            int current = 1;
-            while (arg->s[current] != '"') {
-                newString[current-1] = arg->s[current];
-                ++current;
-            }
-            newString[current-1] = '\0';
-        }
-        printf("%s", newString);
-        return new;
-    }
-    else {
-        Value *result = eval(arg, frame);
-        if (result->type == STR_TYPE) {
-            result = evalDisplay(cons(result, makeNull()), frame);
-        }
-        printTree(result);
-        return new;
-    }
-}
-
-// Evaluates and of any number of boolean parameters.
-Value *evalAnd(Value *args, Frame *frame) {
-    Value *result = makeNull();
-    result->type = BOOL_TYPE;
-    result->s = "#t";
-
-    Value *current = args;
-    while(current->type != NULL_TYPE) {
-        Value *arg = eval(car(current), frame);
-        if (arg->type != BOOL_TYPE) {
-            printf("and: arguments not boolean type");
-            texit(1);
-        }
-        else if (!strcmp(arg->s,"#f")) {
-            return arg;
-        }
-        current = cdr(current);
-    }
-    return result;
-}
-
-// Evaluates or of any number of boolean parameters
-Value *evalOr(Value *args, Frame *frame) {
-    Value *result = makeNull();
-    result->type = BOOL_TYPE;
-    result->s = "#f";
-
-    Value *current = args;
-    while(current->type != NULL_TYPE) {
-        Value *arg = eval(car(current), frame);
-        if (arg->type != BOOL_TYPE) {
-            printf("and: arguments not boolean type");
-            texit(1);
-        }
-        else if (!strcmp(arg->s,"#t")) {
-            return arg;
-        }
-        current = cdr(current);
-    }
-    return result;
-}
-
-// Evaluates argument of a lambda function
-// Returns a closure with the proper code
-Value *evalLambda(Value *args, Frame *frame){
-    Value *closure = makeNull();
-    closure->type = CLOSURE_TYPE;
-    closure->cl.frame = frame;
-
-    Value *params = car(args);
-    Value *current = params;
-    while(current->type != NULL_TYPE) {
-        if(car(current)->type != SYMBOL_TYPE) {
-            printf("lambda: not an identifier");
-            texit(1);
-        }
-        current = cdr(current);
-    }
-    closure->cl.paramNames = params;
-
-    Value *body = cdr(args);
-    closure->cl.functionCode = body;
-    return closure;
-}
-
-// Evaluates body of a define function
-// Returns void_type Value*, creates binding in current frame
-Value *evalDefine(Value *args, Frame *frame) {
-    Value *v = makeNull();
-    v->type = VOID_TYPE;
-    if(length(args) < 2) {
-        printf("define: bad syntax");
-        texit(1);
-    }
-    else if(length(args) > 2) {
-        printf("define: bad syntax (multiple expressions after identifier)");
-        texit(1);
-    }
-    Value *var = car(args);
-    Value *expr = car(cdr(args));
-
-    if (var->type == CONS_TYPE) {
-        Value *first = car(var);
-        if(first->type != SYMBOL_TYPE) {
-            printf("define: bad syntax (not an identifier for procedure name, and not a nested procedure form)");
-            texit(1);
-        }
-        Value *closure1 = evalLambda(cons(cdr(var), cdr(args)), frame);
-        Value *binding = makeNull();
-        binding = cons(first, cons(closure1, binding));
-        frame->bindings = cons(binding, frame->bindings);
-        return v;
-    }
-
-    if(var->type != SYMBOL_TYPE) {
-        printf("define: not an identifier for procedure argument");
-        texit(1);
-    }
-    Value *binding = makeNull();
-    binding = cons(var, cons(eval(expr, frame), binding));
-    frame->bindings = cons(binding, frame->bindings);
-    return v;
-}
-
-// Applies the code of a closure to given arguments
-Value *apply(Value *function, Value *args) {
-    if(function->type != CLOSURE_TYPE) {
-        printf("application: not a procedure;\n"
-               " expected a procedure that can be applied to arguments");
-        texit(1);
-    }
-
-    Frame *frame = talloc(sizeof(Frame));
-    frame->parent = function->cl.frame;
-    frame->bindings = makeNull();
-
-    Value *currentParam = function->cl.paramNames;
-    Value *currentArg = car(args);
-    if (length(currentParam) != length(currentArg)) {
-        printf("#<procedure>: arity mismatch;\n"
-               " the expected number of arguments does not match the given number\n");
-        texit(1);
-    }
-    while(currentParam->type != NULL_TYPE) {
-        Value *binding = makeNull();
-        binding = cons(car(currentParam), cons(car(currentArg), binding));
-        frame->bindings = cons(binding, frame->bindings);
-        currentParam = cdr(currentParam);
-        currentArg = cdr(currentArg);
-    }
-    Value *current = function->cl.functionCode;
-    Value *result = makeNull();
-    while(current->type != NULL_TYPE){
-        result = eval(car(current), frame);
-        current = cdr(current);
-    }
-    return result;
-}
-
-// Evaluates a each argument in a list of arguments.
-Value *evalEach(Value *args, Frame *frame) {
-    Value *current = args;
-    Value *newArgs = makeNull();
-    while (current->type != NULL_TYPE) {
-        Value *result = eval(car(current), frame);
-        newArgs = cons(result, newArgs);
-        current = cdr(current);
-    }
-    newArgs = reverse(newArgs);
-    newArgs = cons(newArgs, makeNull());
-    return newArgs;
-}
-
-// Bind a string to a primitive function.
-void bind(char *name, Value *(*function)(struct Value *), Frame *frame) {
-    Value *val = talloc(sizeof(Value));
-    val->type = PRIMITIVE_TYPE;
-    val->pf = function;
-    Value *symbol = talloc(sizeof(Value));
-    symbol->type = SYMBOL_TYPE;
-    symbol->s = name;
-    Value *binding = cons(symbol, cons(val, makeNull()));
-    frame->bindings = cons(binding, frame->bindings);
-}
-
-// Primitive function for adding numbers.
-Value *primitiveAdd(Value *args) {
-    int resulti = 0;
+#include "symbol.h"
+#include "analyze.h"
+#include "compiler.h"
+#include "vm.h"
+#include "bignum.h"
+#include "rational.h"
+#include "numvector.h"
+#include "vector.h"
+#include "hashtable.h"
+#include "str.h"
+
+// Bind a string to a primitive function, as a global variable. The function
+// takes between minArgs and maxArgs arguments; a maxArgs of -1 means there is
+// no upper limit.
+void bind(char *name, Value *(*function)(int, Value **), int minArgs, int maxArgs) {
+    Primitive *primitive = talloc(sizeof(Primitive));
+    primitive->name = name;
+    primitive->minArgs = minArgs;
+    primitive->maxArgs = maxArgs;
+    primitive->function = function;
+    Value *val = makeValue(PRIMITIVE_TYPE);
+    val->prim = primitive;
+    defineGlobal(globalCell(intern(name)), val);
+}
+
+// Calls a primitive on argc arguments, once they have been checked against
+// its arity.
+Value *applyPrimitive(Value *function, int argc, Value **argv) {
+    Primitive *primitive = function->prim;
+    if (argc < primitive->minArgs || (primitive->maxArgs >= 0 && argc > primitive->maxArgs)) {
+        printf("%s: arity mismatch;\n"
+               " the expected number of arguments does not match the given number", primitive->name);
+        texit(1);
+    }
+    return primitive->function(argc, argv);
+}
+
+// Primitive function for adding numbers. Exact numbers are summed exactly,
+// and doubles separately, until the end.
+Value *primitiveAdd(int argc, Value **argv) {
+    Value *resulti = makeInt(0);
     double resultd = 0;
-    Value *current = car(args);
-    Value *value = makeNull();
-    value->type = INT_TYPE;
-    while (current->type != NULL_TYPE) {
-        if (car(current)->type == INT_TYPE) {
-            resulti += car(current)->i;
+    bool isDouble = false;
+    for (int i = 0; i < argc; i++) {
+        if (isExact(argv[i])) {
+            resulti = exactAdd(resulti, argv[i]);
         }
-        else if (car(current)->type == DOUBLE_TYPE) {
-            resultd += car(current)->d;
-            value->type = DOUBLE_TYPE;
+        else if (typeOf(argv[i]) == DOUBLE_TYPE) {
+            resultd += argv[i]->d;
+            isDouble = true;
         }
         else {
             printf("+: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        current = cdr(current);
-    }
-    if (value->type == DOUBLE_TYPE) {
-        value->d = resulti + resultd;
     }
-    else {
-        value->i = resulti;
+    if (isDouble) {
+        Value *value = makeValue(DOUBLE_TYPE);
+        value->d = exactToDouble(resulti) + resultd;
+        return value;
     }
-    return value;
+    return resulti;
 }
 
 // Primitive function for subtracting numbers.
-Value *primitiveSubtract(Value *args) {
-    int resulti = 0;
+Value *primitiveSubtract(int argc, Value **argv) {
+    Value *resulti = makeInt(0);
     double resultd = 0;
-    Value *current = car(args);
-    Value *value = makeNull();
-    value->type = INT_TYPE;
-    if (length(current) < 2) {
-        resulti = 0;
-        resultd = 0;
-    }
-    else {
-        if (car(current)->type == INT_TYPE) {
-            resulti = car(current)->i;
-            current = cdr(current);
+    bool isDouble = false;
+    int i = 0;
+    if (argc >= 2) {
+        if (isExact(argv[0])) {
+            resulti = argv[0];
         }
-        else if (car(current)->type == DOUBLE_TYPE) {
-            resultd = car(current)->d;
-            value->type = DOUBLE_TYPE;
-            current = cdr(current);
+        else if (typeOf(argv[0]) == DOUBLE_TYPE) {
+            resultd = argv[0]->d;
+            isDouble = true;
         }
         else {
             printf("-: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
+        i = 1;
     }
-    while (current->type != NULL_TYPE) {
-        if (car(current)->type == INT_TYPE) {
-            resulti -= car(current)->i;
-        } else if (car(current)->type == DOUBLE_TYPE) {
-            resultd -= car(current)->d;
-            value->type = DOUBLE_TYPE;
+    for (; i < argc; i++) {
+        if (isExact(argv[i])) {
+            resulti = exactSubtract(resulti, argv[i]);
+        } else if (typeOf(argv[i]) == DOUBLE_TYPE) {
+            resultd -= argv[i]->d;
+            isDouble = true;
         } else {
             printf("-: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        current = cdr(current);
     }
-    if (value->type == DOUBLE_TYPE) {
-        value->d = resulti + resultd;
-    } else {
-        value->i = resulti;
+    if (isDouble) {
+        Value *value = makeValue(DOUBLE_TYPE);
+        value->d = exactToDouble(resulti) + resultd;
+        return value;
     }
-    return value;
+    return resulti;
 }
 
 // Primitive function for multiplying numbers.
-Value *primitiveMult(Value *args) {
-    int resulti = 1;
+Value *primitiveMult(int argc, Value **argv) {
+    Value *resulti = makeInt(1);
     double resultd = 1;
-    Value *current = car(args);
-    Value *value = makeNull();
-    value->type = INT_TYPE;
-    while (current->type != NULL_TYPE) {
-        if (car(current)->type == INT_TYPE) {
-            resulti *= car(current)->i;
+    bool isDouble = false;
+    for (int i = 0; i < argc; i++) {
+        if (isExact(argv[i])) {
+            resulti = exactMultiply(resulti, argv[i]);
         }
-        else if (car(current)->type == DOUBLE_TYPE) {
-            resultd *= car(current)->d;
-            value->type = DOUBLE_TYPE;
+        else if (typeOf(argv[i]) == DOUBLE_TYPE) {
+            resultd *= argv[i]->d;
+            isDouble = true;
         }
         else {
             printf("*: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        current = cdr(current);
     }
-    if (value->type == DOUBLE_TYPE) {
-        value->d = resulti * resultd;
+    if (isDouble) {
+        Value *value = makeValue(DOUBLE_TYPE);
+        value->d = exactToDouble(resulti) * resultd;
+        return value;
     }
-    else {
-        value->i = resulti;
-    }
-    return value;
+    return resulti;
+}
 
+// Whether a Value is a number, exact or not.
+bool isNumber(Value *value) {
+    return isExact(value) || typeOf(value) == DOUBLE_TYPE;
 }
 
-// Primitive function for dividing two numbers.
-Value *primitiveDivide(Value *args) {
-    args = car(args);
-    Value *value = makeNull();
-    value->type = INT_TYPE;
-    Value *first = makeNull();
-    Value *second = makeNull();
-    if (length(args) == 1) {
-        first->type = INT_TYPE;
-        first->i = 1;
-        second = car(args);
-    }
-    else if (length(args) == 0) {
-        printf("/: arity mismatch;\n"
-               " the expected number of arguments does not match the given number\n"
-               "  expected: at least 1");
-        texit(1);
+// Returns a number as a double, for mixed arithmetic.
+double toDouble(Value *number) {
+    return typeOf(number) == DOUBLE_TYPE ? number->d : exactToDouble(number);
+}
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b. Exact numbers are compared exactly.
+int compareNumbers(Value *a, Value *b) {
+    if (isExact(a) && isExact(b)) {
+        return exactCompare(a, b);
     }
-    else if (length(args) >2) {
-        printf("/: arity mismatch;\n"
-               " the expected number of arguments does not match the given number\n"
-               "  expected: 2 or less");
+    double x = toDouble(a);
+    double y = toDouble(b);
+    return (x > y) - (x < y);
+}
+
+// Primitive function for dividing two numbers. Exact numbers give an exact
+// quotient, which is a rational unless it is a whole number.
+Value *primitiveDivide(int argc, Value **argv) {
+    Value *first = argc == 1 ? makeInt(1) : argv[0];
+    Value *second = argv[argc - 1];
+    if (!isNumber(first) || !isNumber(second)) {
+        printf("/: contract violation\n"
+               "  expected: number?");
         texit(1);
     }
-    else {
-        first = car(args);
-        second = car(cdr(args));
-    }
-    if ((second->type == INT_TYPE && second->i == 0) || (second->type == DOUBLE_TYPE && second->d == 0)) {
+    if ((typeOf(second) == INT_TYPE && intValue(second) == 0) || (typeOf(second) == DOUBLE_TYPE && second->d == 0)) {
         printf("/: division by zero");
         texit(1);
     }
-    if (first->type == INT_TYPE && second->type == INT_TYPE) {
-        if (first->i % second->i == 0) {
-            value->i = first->i/second->i;
-        }
-        else {
-            value->type = DOUBLE_TYPE;
-            value->d = (float)first->i/(float)second->i;
-        }
-    }
-    else {
-        if (first->type == INT_TYPE && second->type == DOUBLE_TYPE) {
-            value->type = DOUBLE_TYPE;
-            value->d = (float)first->i/second->d;
-        }
-        else if (first->type == DOUBLE_TYPE && second->type == INT_TYPE) {
-            value->type = DOUBLE_TYPE;
-            value->d = first->d/(float)second->i;
-        }
-        else {
-            value->type = DOUBLE_TYPE;
-            value->d = first->d/second->d;
-        }
+    if (isExact(first) && isExact(second)) {
+        return exactDivide(first, second);
     }
+    Value *value = makeValue(DOUBLE_TYPE);
+    value->d = toDouble(first) / toDouble(second);
     return value;
 }
 
-// Primitive function for mod
-Value *primitiveModulo(Value *args) {
-    args = car(args);
-
-    if(length(args) != 2) {
-        printf("modulo: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-
-    Value *first = car(args);
-    Value *second = car(cdr(args));
+// Primitive function for mod. The result has the sign of the first argument,
+// and rationals are divided a whole number of times.
+Value *primitiveModulo(int argc, Value **argv) {
+    Value *first = argv[0];
+    Value *second = argv[1];
 
-    if(!(first->type == INT_TYPE && second->type == INT_TYPE)) {
+    if(!(isExact(first) && isExact(second))) {
         printf("modulo: contract violation\n"
-               "  expected: integer?");
+               "  expected: rational?");
         texit(1);
     }
 
-    if(second->i == 0) {
+    if(second == makeInt(0)) {
         printf("modulo: undefined for 0");
         texit(1);
     }
 
-    Value *val = makeNull();
-    val->type = INT_TYPE;
-    val->i = first->i % second->i;
-    return val;
+    return exactRemainder(first, second);
 }
 
 // Primitive function for checking if something is nothing (whaaa? ¯\_(ツ)_/¯)
-Value *primitiveNull(Value *args) {
-    args = car(args);
-    if (length(args) != 1) {
-        printf("null?: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    Value *value = makeNull();
-    value->type = BOOL_TYPE;
-    value->s = "#t";
-    if (car(args)->type != NULL_TYPE) {
-        value->s = "#f";
-    }
-    return value;
+Value *primitiveNull(int argc, Value **argv) {
+    return makeBool(typeOf(argv[0]) == NULL_TYPE);
 }
 
 // Primitive function for getting the car of a cons cell.
-Value *primitiveCar(Value *args) {
-    args = car(args);
-    if(length(args) != 1) {
-        printf("car: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    if(car(args)->type != CONS_TYPE) {
+Value *primitiveCar(int argc, Value **argv) {
+    if(typeOf(argv[0]) != CONS_TYPE) {
         printf("car: contract violation\n"
                "  expected: pair?");
         texit(1);
     }
-    Value *lst = car(args);
-    return car(lst);
+    return car(argv[0]);
 }
 
 // Primitive function for getting the cdr of a cons cell.
-Value *primitiveCdr(Value *args) {
-    args = car(args);
-    if(length(args) != 1) {
-        printf("cdr: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    if(car(args)->type != CONS_TYPE) {
+Value *primitiveCdr(int argc, Value **argv) {
+    if(typeOf(argv[0]) != CONS_TYPE) {
         printf("cdr: contract violation\n"
                "  expected: pair?");
         texit(1);
     }
-    Value *lst = car(args);
-    return cdr(lst);
+    return cdr(argv[0]);
 }
 
 // Primitive function for creating a cons cell from two arguments.
-Value *primitiveCons(Value *args) {
-    args = car(args);
-    if(length(args) != 2) {
-        printf("cons: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    Value *consCell = cons(car(args), car(cdr(args)));
-    return consCell;
+Value *primitiveCons(int argc, Value **argv) {
+    return cons(argv[0], argv[1]);
 }
 
 // Primitive function for creating a list from the arguments.
-Value *primitiveList(Value *args) {
-    args = car(args);
-    return args;
+Value *primitiveList(int argc, Value **argv) {
+    Value *list = makeNull();
+    for (int i = argc - 1; i >= 0; i--) {
+        list = cons(argv[i], list);
+    }
+    return list;
 }
 
 // Primitive function for appending values to a list.
-Value *primitiveAppend(Value *args) {
-    args = car(args);
-    if (length(args) == 0) {
+Value *primitiveAppend(int argc, Value **argv) {
+    if (argc == 0) {
         return makeNull();
     }
-    else if (length(args) == 1) {
-        return car(args);
+    else if (argc == 1) {
+        return argv[0];
     }
 
     Value *newList = makeNull();
-    Value *current = args;
-    while (current->type != NULL_TYPE) {
-        if(car(current)->type != CONS_TYPE && cdr(current)->type != NULL_TYPE) {
+    for (int i = 0; i < argc; i++) {
+        if(typeOf(argv[i]) != CONS_TYPE && i != argc - 1) {
             printf("append: contract violation\n"
                    "  expected: list?");
             texit(1);
         }
-        if(car(current)->type == CONS_TYPE) {
-            Value *innerCurrent = car(current);
-            while(innerCurrent->type != NULL_TYPE) {
+        if(typeOf(argv[i]) == CONS_TYPE) {
+            Value *innerCurrent = argv[i];
+            while(typeOf(innerCurrent) != NULL_TYPE) {
                 newList = cons(car(innerCurrent), newList);
                 innerCurrent = cdr(innerCurrent);
             }
         }
         else {
-            newList = cons(car(current), newList);
+            newList = cons(argv[i], newList);
         }
-        current = cdr(current);
     }
     newList = reverse(newList);
     return newList;
@@ -827,247 +275,182 @@ Value *primitiveAppend(Value *args) {
 }
 
 // Primitive function for eq, return #t if v1 and v2 refer to the same object, #f otherwise.
-Value *primitiveEq(Value *args) {
-    args = car(args);
-    if(length(args) != 2) {
-        printf("eq?: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    Value *first = car(args);
-    Value *second = car(cdr(args));
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if (first != second) {
-        return valueF;
-    }
-    return valueT;
-}
-
-// Primitive function for equality, compares if values of two Values are equal
-Value *primitiveEqual(Value *args) {
-    args = car(args);
-    if(length(args) != 2) {
-        printf("equal?: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-    Value *first = car(args);
-    Value *second = car(cdr(args));
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if (first->type == second->type) {
-        switch(first->type) {
-            case INT_TYPE: {
-                if (first->i == second->i) {
-                    return valueT;
-                }
-                return valueF;
+Value *primitiveEq(int argc, Value **argv) {
+    return makeBool(argv[0] == argv[1]);
+}
+
+// Compares two Values that aren't lists or vectors, or the types of two that
+// are (and the lengths of two vectors).
+bool atomsEqual(Value *first, Value *second) {
+    if (first == second) {
+        return true;
+    }
+    if (typeOf(first) != typeOf(second)) {
+        return false;
+    }
+    switch(typeOf(first)) {
+        case DOUBLE_TYPE:
+            return first->d == second->d;
+        case BIGNUM_TYPE:
+        case RATIONAL_TYPE:
+            return exactCompare(first, second) == 0;
+        case F64VECTOR_TYPE:
+        case S64VECTOR_TYPE:
+            return numericVectorsEqual(first, second);
+        case CONS_TYPE:
+            return true;
+        case VECTOR_TYPE:
+            return first->vec.count == second->vec.count;
+        case STR_TYPE:
+            return stringsEqual(first, second);
+        case SYMBOL_TYPE:
+        case SINGLE_QUOTE_TYPE:
+            return !strcmp(first->s, second->s);
+        default:
+            // Integers, booleans, () and void are immediates, so equal ones
+            // are the same pointer.
+            return false;
+    }
+}
+
+// Compares the values of two Values, walking lists and vectors element by
+// element. Pairs of cdrs and of vector elements still to be compared are kept
+// on a stack while the cars are, rather than recursing, so deeply nested lists
+// can't overflow the C stack.
+bool valuesEqual(Value *first, Value *second) {
+    int count = 0;
+    int capacity = 32;
+    Value *onStack[32];
+    Value **pending = onStack;
+    while (true) {
+        if (first != second) {
+            if (!atomsEqual(first, second)) {
+                return false;
             }
-            case DOUBLE_TYPE: {
-                if (first->d == second->d) {
-                    return valueT;
-                }
-                return valueF;
+            int needed = 0;
+            if (typeOf(first) == CONS_TYPE) {
+                needed = 2;
             }
-            case CONS_TYPE: {
-                Value *currentFirst = first;
-                Value *currentSecond = second;
-                while(currentFirst->type != NULL_TYPE) {
-                    Value *newArgs = cons(cons(car(currentFirst), cons(car(currentSecond), makeNull())), makeNull());
-                    if(!(strcmp(primitiveEqual(newArgs)->s, "#f"))) {
-                        return valueF;
-                    }
-                    currentFirst = cdr(currentFirst);
-                    currentSecond = cdr(currentSecond);
+            else if (typeOf(first) == VECTOR_TYPE) {
+                needed = 2 * first->vec.count;
+            }
+            if (count + needed > capacity) {
+                while (count + needed > capacity) {
+                    capacity *= 2;
                 }
-                return valueT;
+                Value **grown = talloc(sizeof(Value *) * capacity);
+                memcpy(grown, pending, sizeof(Value *) * count);
+                pending = grown;
             }
-            case NULL_TYPE: {
-                return valueT;
+            if (typeOf(first) == CONS_TYPE) {
+                pending[count++] = cdr(first);
+                pending[count++] = cdr(second);
+                first = car(first);
+                second = car(second);
+                continue;
             }
-            default: {
-                if(!strcmp(first->s, second->s)) {
-                    return valueT;
-                }
-                return valueF;
+            for (int i = needed / 2 - 1; i >= 0; i--) {
+                pending[count++] = first->vec.items[i];
+                pending[count++] = second->vec.items[i];
             }
         }
+        if (count == 0) {
+            return true;
+        }
+        second = pending[--count];
+        first = pending[--count];
     }
-    return valueF;
 }
 
-// Primitive function for >. Compare integer values.
-Value *primitiveGreaterThan(Value *args) {
-    args = car(args);
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if(length(args) == 0) {
-        printf(">: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
+// Primitive function for equality, compares if values of two Values are equal
+Value *primitiveEqual(int argc, Value **argv) {
+    return makeBool(valuesEqual(argv[0], argv[1]));
+}
 
-    Value *current = args;
-    int previous = car(current)->i;
-    while(current->type != NULL_TYPE) {
-        if(car(current)->type != INT_TYPE) {
-            printf(">: contract violation\n"
+// Primitive function for =. Compare numeric values.
+Value *primitiveNumberEqual(int argc, Value **argv) {
+    for (int i = 0; i < argc; i++) {
+        if(!isNumber(argv[i])) {
+            printf("=: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        if(car(current)->i >= previous) {
-            return valueF;
+        if(i > 0 && !(compareNumbers(argv[i - 1], argv[i]) == 0)) {
+            return FALSE_VALUE;
         }
-        previous = car(current)->i;
-        current = cdr(current);
     }
-    return valueT;
+    return TRUE_VALUE;
 }
 
-// Primitive function for >=. Compare integer values.
-Value *primitiveGreaterThanOrEqual(Value *args) {
-    args = car(args);
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if(length(args) == 0) {
-        printf(">: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-
-    Value *current = args;
-    int previous = car(current)->i;
-    while(current->type != NULL_TYPE) {
-        if(car(current)->type != INT_TYPE) {
+// Primitive function for >. Compare numeric values.
+Value *primitiveGreaterThan(int argc, Value **argv) {
+    for (int i = 0; i < argc; i++) {
+        if(!isNumber(argv[i])) {
             printf(">: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        if(car(current)->i > previous) {
-            return valueF;
+        if(i > 0 && !(compareNumbers(argv[i - 1], argv[i]) > 0)) {
+            return FALSE_VALUE;
         }
-        previous = car(current)->i;
-        current = cdr(current);
     }
-    return valueT;
+    return TRUE_VALUE;
 }
 
-// Primitive function for <. Compare integer values
-Value *primitiveLessThan(Value *args) {
-    args = car(args);
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if(length(args) == 0) {
-        printf("<: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
+// Primitive function for >=. Compare numeric values.
+Value *primitiveGreaterThanOrEqual(int argc, Value **argv) {
+    for (int i = 0; i < argc; i++) {
+        if(!isNumber(argv[i])) {
+            printf(">=: contract violation\n"
+                   "  expected: number?");
+            texit(1);
+        }
+        if(i > 0 && !(compareNumbers(argv[i - 1], argv[i]) >= 0)) {
+            return FALSE_VALUE;
+        }
     }
+    return TRUE_VALUE;
+}
 
-    Value *current = args;
-    int previous = car(current)->i;
-    while(current->type != NULL_TYPE) {
-        if(car(current)->type != INT_TYPE) {
+// Primitive function for <. Compare numeric values.
+Value *primitiveLessThan(int argc, Value **argv) {
+    for (int i = 0; i < argc; i++) {
+        if(!isNumber(argv[i])) {
             printf("<: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        if(car(current)->i <= previous) {
-            return valueF;
+        if(i > 0 && !(compareNumbers(argv[i - 1], argv[i]) < 0)) {
+            return FALSE_VALUE;
         }
-        previous = car(current)->i;
-        current = cdr(current);
     }
-    return valueT;
+    return TRUE_VALUE;
 }
 
-// Primitive function for <=. Compare integer values
-Value *primitiveLessThanOrEqual(Value *args) {
-    args = car(args);
-    Value *valueT = makeNull();
-    valueT->type = BOOL_TYPE;
-    valueT->s = "#t";
-    Value *valueF = makeNull();
-    valueF->type = BOOL_TYPE;
-    valueF->s = "#f";
-
-    if(length(args) == 0) {
-        printf("<: arity mismatch;\n"
-               " the expected number of arguments does not match the given number");
-        texit(1);
-    }
-
-    Value *current = args;
-    int previous = car(current)->i;
-    while(current->type != NULL_TYPE) {
-        if(car(current)->type != INT_TYPE) {
-            printf("<: contract violation\n"
+// Primitive function for <=. Compare numeric values.
+Value *primitiveLessThanOrEqual(int argc, Value **argv) {
+    for (int i = 0; i < argc; i++) {
+        if(!isNumber(argv[i])) {
+            printf("<=: contract violation\n"
                    "  expected: number?");
             texit(1);
         }
-        if(car(current)->i < previous) {
-            return valueF;
+        if(i > 0 && !(compareNumbers(argv[i - 1], argv[i]) <= 0)) {
+            return FALSE_VALUE;
         }
-        previous = car(current)->i;
-        current = cdr(current);
     }
-    return valueT;
+    return TRUE_VALUE;
 }
 
 // Primitive function for loading and interpreting a file,
 // given an input path in string form
-Value *primitiveLoadFile(Value *args) {
-    args = car(args);
-    if(length(args) != 1) {
-        printf("loadfile expected 1 argument");
-        texit(1);
-    }
-    if(car(args)->type != STR_TYPE) {
+Value *primitiveLoadFile(int argc, Value **argv) {
+    if(typeOf(argv[0]) != STR_TYPE) {
         printf("loadfile expected string argument");
+        texit(1);
     }
 
-    Value *arg = car(args);
-
-    char *newString = talloc(sizeof(char[255]));
-    newString[0] = '\0';
-    if (arg->s[1] == '"') {
-        newString = "\0";
-    }
-    else {
-        int current = 1;
-        while (arg->s[current] != '"') {
-            newString[current-1] = arg->s[current];
-            ++current;
-        }
-        newString[current-1] = '\0';
-    }
-
-    char *inputFileName = newString;
+    char *inputFileName = argv[0]->str.bytes;
 //    char fullInputPath[2000];
 //    strcpy(fullInputPath, "../inputfiles/");
 //    strcat(fullInputPath, inputFileName);
@@ -1079,176 +462,51 @@ Value *primitiveLoadFile(Value *args) {
 }
 
 
-// Calls evaluation on the parse tree,
-// Prints out each evaluation to a new line.
-void interpret(Value *tree) {
-    Frame *global = talloc(sizeof(Frame));
-    global->bindings = makeNull();
-    global->parent = NULL;
-    Value *current = tree;
-
-    bind("+",primitiveAdd,global);
-    bind("null?", primitiveNull, global);
-    bind("car", primitiveCar, global);
-    bind("cdr", primitiveCdr, global);
-    bind("cons", primitiveCons, global);
-    bind("equal?", primitiveEqual, global);
-    bind("eq?", primitiveEq, global);
-    bind("append", primitiveAppend, global);
-    bind(">", primitiveGreaterThan, global);
-    bind("<", primitiveLessThan, global);
-    bind("list", primitiveList, global);
-    bind("*", primitiveMult, global);
-    bind("/", primitiveDivide, global);
-    bind("-", primitiveSubtract, global);
-    bind(">=", primitiveGreaterThanOrEqual, global);
-    bind("<=", primitiveLessThanOrEqual, global);
-    bind("modulo", primitiveModulo, global);
-    bind("loadfile", primitiveLoadFile, global);
-
-
-    while(current->type != NULL_TYPE) {
-        Value *result = eval(car(current), global);
-        if (result->type != VOID_TYPE) {
+// Reads the top-level forms of a source one at a time, evaluating each as
+// soon as it has been read. Prints out each evaluation to a new line. Only one
+// form is held at a time, so the memory used depends on the size of the
+// largest form rather than of the whole source.
+// If compiled is set, each expression is compiled to bytecode and run by the
+// VM instead of being executed as analyzed.
+void interpret(Source *source, bool compiled) {
+    initAnalyzer();
+
+    bind("+", primitiveAdd, 0, -1);
+    bind("null?", primitiveNull, 1, 1);
+    bind("car", primitiveCar, 1, 1);
+    bind("cdr", primitiveCdr, 1, 1);
+    bind("cons", primitiveCons, 2, 2);
+    bind("equal?", primitiveEqual, 2, 2);
+    bind("eq?", primitiveEq, 2, 2);
+    bind("append", primitiveAppend, 0, -1);
+    bind(">", primitiveGreaterThan, 1, -1);
+    bind("<", primitiveLessThan, 1, -1);
+    bind("=", primitiveNumberEqual, 1, -1);
+    bind("list", primitiveList, 0, -1);
+    bind("*", primitiveMult, 0, -1);
+    bind("/", primitiveDivide, 1, 2);
+    bind("-", primitiveSubtract, 0, -1);
+    bind(">=", primitiveGreaterThanOrEqual, 1, -1);
+    bind("<=", primitiveLessThanOrEqual, 1, -1);
+    bind("modulo", primitiveModulo, 2, 2);
+    bind("loadfile", primitiveLoadFile, 1, 1);
+    bindVectors();
+    bindNumericVectors();
+    bindHashTables();
+
+    Value *expr;
+    while((expr = readDatum(source)) != NULL) {
+        Node *node = analyze(expr);
+        Value *result = compiled ? runCode(compile(node), NULL) : execute(node, NULL);
+        if (typeOf(result) != VOID_TYPE) {
             printTree(result);
             printf("\n");
         }
-        current = cdr(current);
     }
 }
 
-// Evaluates the parse tree returned by our parser, token by token.
-Value *eval(Value *expr, Frame *frame) {
-    Value *newTree = makeNull();
-    switch(expr->type) {
-        case INT_TYPE: {
-            return expr;
-        }
-        case DOUBLE_TYPE: {
-            return expr;
-        }
-        case BOOL_TYPE: {
-            return expr;
-        }
-        case STR_TYPE: {
-            return expr;
-        }
-        case SYMBOL_TYPE: {
-            return lookUpSymbol(expr, frame);
-        }
-        case SINGLE_QUOTE_TYPE: {
-            return expr;
-        }
-        case CONS_TYPE: {
-            Value *first = car(expr);
-            Value *args = cdr(expr);
-
-            // Error checking
-            if (first->type == CONS_TYPE) {
-                return apply(eval(first, frame), args);
-            }
-            if (first->type != SYMBOL_TYPE && first->type != CLOSURE_TYPE) {
-                printf("application: not a procedure;\n"
-                       " expected a procedure that can be applied to arguments");
-                texit(1);
-            }
-
-            Value *result;
-            if (!strcmp(first->s,"if")) {
-                result = evalIf(args,frame);
-                return result;
-            }
-            else if (!strcmp(first->s,"let")) {
-                result = evalLet(args,frame);
-                return result;
-            }
-            else if (!strcmp(first->s,"let*")) {
-                result = evalLetStar(args,frame);
-                return result;
-            }
-            else if (!strcmp(first->s,"letrec")) {
-                result = evalLetRec(args,frame);
-                return result;
-            }
-
-            else if (!strcmp(first->s,"display")) {
-                result = evalDisplay(cdr(expr), frame);
-                return result;
-            }
-
-            else if (!strcmp(first->s,"when")) {
-                result = evalWhen(cdr(expr), frame);
-                return result;
-            }
-
-            else if (!strcmp(first->s,"unless")) {
-                result = evalUnless(cdr(expr), frame);
-                return result;
-            }
-
-            else if (!strcmp(first->s,"quote")) {
-                if (length(args) != 1) {
-                    printf("quote: bad syntax");
-                    texit(1);
-                }
-                return car(cdr(expr));
-            }
-
-            else if (!strcmp(first->s,"define")) {
-                return evalDefine(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"set!")) {
-                return evalSet(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"lambda")) {
-                return evalLambda(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"and")) {
-                return evalAnd(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"or")) {
-                return evalOr(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"begin")) {
-                return evalBegin(cdr(expr), frame);
-            }
-
-            else if (!strcmp(first->s,"cond")) {
-                return evalCond(cdr(expr), frame);
-            }
-
-            else {
-                // If not a special form, evaluate the first, evaluate the args, then
-                // apply the first to the args.
-                Value *evaledOperator = eval(first, frame);
-                Value *evaledArgs = evalEach(args, frame);
-                if (evaledOperator->type == PRIMITIVE_TYPE) {
-                    if (!strcmp(first->s, "loadfile")) {
-                        Value *current = evaledOperator->pf(evaledArgs);
-                        while(current->type != NULL_TYPE) {
-                            Value *result1 = eval(car(current), frame);
-                            if (result1->type != VOID_TYPE) {
-                                printTree(result1);
-                                printf("\n");
-                            }
-                            current = cdr(current);
-                        }
-                        Value *v = makeNull();
-                        v->type = VOID_TYPE;
-                        return v;
-                    }
-                    return evaledOperator->pf(evaledArgs);
-                }
-                return apply(evaledOperator,evaledArgs);
-            }
-        }
-        default:
-            break;
-    }
-    return newTree;
+// Evaluates an expression at top level, by analyzing it and running the
+// result.
+Value *eval(Value *expr) {
+    return execute(analyze(expr), NULL);
 }
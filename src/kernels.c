@@ -0,0 +1,671 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_KERNELS
+#endif
+
+// The vector kernels below handle as many whole vectors of elements as fit,
+// and pass what is left over to the portable kernel. They use unaligned loads
+// and stores, since talloc only aligns to 8 bytes. The SSE2 and AVX2 versions
+// are compiled for those instruction sets whatever the compiler's flags say,
+// and are only ever called once getKernels has checked the CPU for them.
+
+// Portable kernels.
+
+// Applies op to each element of a and of b, or to each of a and b[0].
+void mapF64Scalar(kernelOp op, double *out, double *a, double *b, bool scalar, int64_t n) {
+    int64_t step = scalar ? 0 : 1;
+    switch (op) {
+        case KERNEL_ADD:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = a[i] + b[i * step];
+            }
+            break;
+        case KERNEL_SUBTRACT:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = a[i] - b[i * step];
+            }
+            break;
+        case KERNEL_MULTIPLY:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = a[i] * b[i * step];
+            }
+            break;
+        case KERNEL_DIVIDE:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = a[i] / b[i * step];
+            }
+            break;
+    }
+}
+
+// Like mapF64Scalar. The int64_t kernels compute in uint64_t, where overflow
+// wraps around.
+void mapS64Scalar(kernelOp op, int64_t *out, int64_t *a, int64_t *b, bool scalar, int64_t n) {
+    int64_t step = scalar ? 0 : 1;
+    switch (op) {
+        case KERNEL_ADD:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = (int64_t)((uint64_t)a[i] + (uint64_t)b[i * step]);
+            }
+            break;
+        case KERNEL_SUBTRACT:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = (int64_t)((uint64_t)a[i] - (uint64_t)b[i * step]);
+            }
+            break;
+        case KERNEL_MULTIPLY:
+            for (int64_t i = 0; i < n; i++) {
+                out[i] = (int64_t)((uint64_t)a[i] * (uint64_t)b[i * step]);
+            }
+            break;
+        case KERNEL_DIVIDE:
+            break;
+    }
+}
+
+// Adds up the elements of a.
+double sumF64Scalar(double *a, int64_t n) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += a[i];
+    }
+    return sum;
+}
+
+// Returns x if it is less than min, and min otherwise. -0.0 counts as less
+// than 0.0, and a NaN is never less than anything, nor anything less than it.
+double lesserF64(double x, double min) {
+    return x < min || (x == min && signbit(x)) ? x : min;
+}
+
+// Returns x if it is greater than max, and max otherwise. 0.0 counts as
+// greater than -0.0, and a NaN is never greater than anything, nor anything
+// greater than it.
+double greaterF64(double x, double max) {
+    return x > max || (x == max && !signbit(x)) ? x : max;
+}
+
+// Returns the smallest of the n > 0 elements of a: a[0] if it is a NaN, and
+// otherwise the smallest of the elements that aren't.
+double minF64Scalar(double *a, int64_t n) {
+    double min = a[0];
+    for (int64_t i = 1; i < n; i++) {
+        min = lesserF64(a[i], min);
+    }
+    return min;
+}
+
+// Returns the largest of the n > 0 elements of a: a[0] if it is a NaN, and
+// otherwise the largest of the elements that aren't.
+double maxF64Scalar(double *a, int64_t n) {
+    double max = a[0];
+    for (int64_t i = 1; i < n; i++) {
+        max = greaterF64(a[i], max);
+    }
+    return max;
+}
+
+// Adds up the products of the elements of a and b.
+double dotF64Scalar(double *a, double *b, int64_t n) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Adds up the elements of a.
+int64_t sumS64Scalar(int64_t *a, int64_t n) {
+    uint64_t sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += (uint64_t)a[i];
+    }
+    return (int64_t)sum;
+}
+
+// Returns the smallest of the n > 0 elements of a.
+int64_t minS64Scalar(int64_t *a, int64_t n) {
+    int64_t min = a[0];
+    for (int64_t i = 1; i < n; i++) {
+        min = a[i] < min ? a[i] : min;
+    }
+    return min;
+}
+
+// Returns the largest of the n > 0 elements of a.
+int64_t maxS64Scalar(int64_t *a, int64_t n) {
+    int64_t max = a[0];
+    for (int64_t i = 1; i < n; i++) {
+        max = a[i] > max ? a[i] : max;
+    }
+    return max;
+}
+
+// Adds up the products of the elements of a and b.
+int64_t dotS64Scalar(int64_t *a, int64_t *b, int64_t n) {
+    uint64_t sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += (uint64_t)a[i] * (uint64_t)b[i];
+    }
+    return (int64_t)sum;
+}
+
+// Sets each element of out to the sum of a up to there.
+void scanF64Scalar(double *out, double *a, int64_t n) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += a[i];
+        out[i] = sum;
+    }
+}
+
+// Sets each element of out to the sum of a up to there.
+void scanS64Scalar(int64_t *out, int64_t *a, int64_t n) {
+    uint64_t sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += (uint64_t)a[i];
+        out[i] = (int64_t)sum;
+    }
+}
+
+// The classes of each character: whitespace is space and \t through \r,
+// the other delimiters are ( ) [ ] ' and ;, and the symbol constituents are
+// letters, digits and ! $ % & * + - . / : < = > ? ^ _ ~, all of which but
+// digits, + - and . can also start a symbol.
+const unsigned char charClasses[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x02, 0x02, 0x02, 0x18, 0x08, 0x00, 0x08, 0x08, 0x18,
+    0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x18, 0x02, 0x18, 0x18, 0x18, 0x18,
+    0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x02, 0x00, 0x02, 0x18, 0x18,
+    0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00,
+};
+
+// Classifies 32 characters, one at a time.
+CharMasks classifyCharsScalar(char *text) {
+    CharMasks masks = {0, 0, 0, 0};
+    for (int i = 0; i < 32; i++) {
+        unsigned char classes = charClasses[(unsigned char)text[i]];
+        masks.whitespace |= (uint32_t)((classes & CHAR_WHITESPACE) != 0) << i;
+        masks.delimiters |= (uint32_t)((classes & CHAR_DELIMITER) != 0) << i;
+        masks.digits |= (uint32_t)((classes & CHAR_DIGIT) != 0) << i;
+        masks.symbols |= (uint32_t)((classes & CHAR_SYMBOL) != 0) << i;
+    }
+    return masks;
+}
+
+#ifdef X86_KERNELS
+
+// SSE2 kernels, two elements at a time. Each does what the portable kernel
+// with the same name does.
+
+__attribute__((target("sse2")))
+void mapF64SSE2(kernelOp op, double *out, double *a, double *b, bool scalar, int64_t n) {
+    __m128d broadcast = _mm_set1_pd(b[0]);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        __m128d y = scalar ? broadcast : _mm_loadu_pd(b + i);
+        switch (op) {
+            case KERNEL_ADD:
+                x = _mm_add_pd(x, y);
+                break;
+            case KERNEL_SUBTRACT:
+                x = _mm_sub_pd(x, y);
+                break;
+            case KERNEL_MULTIPLY:
+                x = _mm_mul_pd(x, y);
+                break;
+            case KERNEL_DIVIDE:
+                x = _mm_div_pd(x, y);
+                break;
+        }
+        _mm_storeu_pd(out + i, x);
+    }
+    mapF64Scalar(op, out + i, a + i, scalar ? b : b + i, scalar, n - i);
+}
+
+// SSE2 has no 64-bit multiply, so products are left to the portable kernel.
+__attribute__((target("sse2")))
+void mapS64SSE2(kernelOp op, int64_t *out, int64_t *a, int64_t *b, bool scalar, int64_t n) {
+    __m128i broadcast = _mm_set1_epi64x(b[0]);
+    int64_t i = 0;
+    if (op == KERNEL_ADD || op == KERNEL_SUBTRACT) {
+        for (; i + 2 <= n; i += 2) {
+            __m128i x = _mm_loadu_si128((__m128i *)(a + i));
+            __m128i y = scalar ? broadcast : _mm_loadu_si128((__m128i *)(b + i));
+            x = op == KERNEL_ADD ? _mm_add_epi64(x, y) : _mm_sub_epi64(x, y);
+            _mm_storeu_si128((__m128i *)(out + i), x);
+        }
+    }
+    mapS64Scalar(op, out + i, a + i, scalar ? b : b + i, scalar, n - i);
+}
+
+__attribute__((target("sse2")))
+double sumF64SSE2(double *a, int64_t n) {
+    __m128d sum = _mm_setzero_pd();
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        sum = _mm_add_pd(sum, _mm_loadu_pd(a + i));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + sumF64Scalar(a + i, n - i);
+}
+
+// _mm_min_pd and _mm_max_pd return their second operand if either is a NaN
+// or both are zeros, so the running result goes second and keeps a NaN out.
+// Where the two are equal, ORing them makes -0.0 the lesser zero, and ANDing
+// them makes 0.0 the greater; equal nonzero doubles have the same bits.
+
+__attribute__((target("sse2")))
+double minF64SSE2(double *a, int64_t n) {
+    __m128d min = _mm_set1_pd(a[0]);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        min = _mm_or_pd(_mm_min_pd(x, min), _mm_and_pd(x, _mm_cmpeq_pd(x, min)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, min);
+    double result = lesserF64(lanes[1], lanes[0]);
+    for (; i < n; i++) {
+        result = lesserF64(a[i], result);
+    }
+    return result;
+}
+
+__attribute__((target("sse2")))
+double maxF64SSE2(double *a, int64_t n) {
+    __m128d max = _mm_set1_pd(a[0]);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        max = _mm_and_pd(_mm_max_pd(x, max), _mm_or_pd(x, _mm_cmpneq_pd(x, max)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, max);
+    double result = greaterF64(lanes[1], lanes[0]);
+    for (; i < n; i++) {
+        result = greaterF64(a[i], result);
+    }
+    return result;
+}
+
+__attribute__((target("sse2")))
+double dotF64SSE2(double *a, double *b, int64_t n) {
+    __m128d sum = _mm_setzero_pd();
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + dotF64Scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+int64_t sumS64SSE2(int64_t *a, int64_t n) {
+    __m128i sum = _mm_setzero_si128();
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        sum = _mm_add_epi64(sum, _mm_loadu_si128((__m128i *)(a + i)));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    return (int64_t)((uint64_t)lanes[0] + (uint64_t)lanes[1] + (uint64_t)sumS64Scalar(a + i, n - i));
+}
+
+// Each pair is summed in its register, [x0, x1] becoming [x0, x0 + x1], and
+// then the total so far is added to both.
+__attribute__((target("sse2")))
+void scanF64SSE2(double *out, double *a, int64_t n) {
+    __m128d carry = _mm_setzero_pd();
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        x = _mm_add_pd(x, _mm_unpacklo_pd(_mm_setzero_pd(), x));
+        x = _mm_add_pd(x, carry);
+        _mm_storeu_pd(out + i, x);
+        carry = _mm_unpackhi_pd(x, x);
+    }
+    double total = _mm_cvtsd_f64(carry);
+    for (; i < n; i++) {
+        total += a[i];
+        out[i] = total;
+    }
+}
+
+// The characters classified by the vector kernels: each class is a union of
+// ranges of characters, found by subtracting the start of the range and
+// comparing, unsigned, with its length. Bytes past 127 are past every range.
+
+// Marks the characters from low to high in c with 0xff.
+__attribute__((target("sse2")))
+__m128i inRangeSSE2(__m128i c, char low, char high) {
+    __m128i offset = _mm_sub_epi8(c, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(high - low)), offset);
+}
+
+// Classifies 16 characters, adding their masks to those of the first shift
+// characters.
+__attribute__((target("sse2")))
+void classify16SSE2(char *text, int shift, CharMasks *masks) {
+    __m128i c = _mm_loadu_si128((__m128i *)text);
+    __m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+                                      inRangeSSE2(c, '\t', '\r'));
+    __m128i delimiters = _mm_or_si128(whitespace, inRangeSSE2(c, '\'', ')'));
+    delimiters = _mm_or_si128(delimiters, _mm_cmpeq_epi8(c, _mm_set1_epi8('[')));
+    delimiters = _mm_or_si128(delimiters, _mm_cmpeq_epi8(c, _mm_set1_epi8(']')));
+    delimiters = _mm_or_si128(delimiters, _mm_cmpeq_epi8(c, _mm_set1_epi8(';')));
+    __m128i symbols = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('!')),
+                                   _mm_cmpeq_epi8(c, _mm_set1_epi8('~')));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, '$', '&'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, '*', '+'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, '-', ':'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, '<', '?'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, 'A', 'Z'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, '^', '_'));
+    symbols = _mm_or_si128(symbols, inRangeSSE2(c, 'a', 'z'));
+    masks->whitespace |= (uint32_t)_mm_movemask_epi8(whitespace) << shift;
+    masks->delimiters |= (uint32_t)_mm_movemask_epi8(delimiters) << shift;
+    masks->digits |= (uint32_t)_mm_movemask_epi8(inRangeSSE2(c, '0', '9')) << shift;
+    masks->symbols |= (uint32_t)_mm_movemask_epi8(symbols) << shift;
+}
+
+// Classifies 32 characters, 16 at a time.
+__attribute__((target("sse2")))
+CharMasks classifyCharsSSE2(char *text) {
+    CharMasks masks = {0, 0, 0, 0};
+    classify16SSE2(text, 0, &masks);
+    classify16SSE2(text + 16, 16, &masks);
+    return masks;
+}
+
+// AVX2 kernels, four elements at a time.
+
+__attribute__((target("avx2")))
+void mapF64AVX2(kernelOp op, double *out, double *a, double *b, bool scalar, int64_t n) {
+    __m256d broadcast = _mm256_set1_pd(b[0]);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        __m256d y = scalar ? broadcast : _mm256_loadu_pd(b + i);
+        switch (op) {
+            case KERNEL_ADD:
+                x = _mm256_add_pd(x, y);
+                break;
+            case KERNEL_SUBTRACT:
+                x = _mm256_sub_pd(x, y);
+                break;
+            case KERNEL_MULTIPLY:
+                x = _mm256_mul_pd(x, y);
+                break;
+            case KERNEL_DIVIDE:
+                x = _mm256_div_pd(x, y);
+                break;
+        }
+        _mm256_storeu_pd(out + i, x);
+    }
+    mapF64Scalar(op, out + i, a + i, scalar ? b : b + i, scalar, n - i);
+}
+
+// AVX2 has no 64-bit multiply either.
+__attribute__((target("avx2")))
+void mapS64AVX2(kernelOp op, int64_t *out, int64_t *a, int64_t *b, bool scalar, int64_t n) {
+    __m256i broadcast = _mm256_set1_epi64x(b[0]);
+    int64_t i = 0;
+    if (op == KERNEL_ADD || op == KERNEL_SUBTRACT) {
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+            __m256i y = scalar ? broadcast : _mm256_loadu_si256((__m256i *)(b + i));
+            x = op == KERNEL_ADD ? _mm256_add_epi64(x, y) : _mm256_sub_epi64(x, y);
+            _mm256_storeu_si256((__m256i *)(out + i), x);
+        }
+    }
+    mapS64Scalar(op, out + i, a + i, scalar ? b : b + i, scalar, n - i);
+}
+
+__attribute__((target("avx2")))
+double sumF64AVX2(double *a, int64_t n) {
+    __m256d sum = _mm256_setzero_pd();
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(a + i));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumF64Scalar(a + i, n - i);
+}
+
+// These keep NaNs out and order zeros as the SSE2 versions do.
+
+__attribute__((target("avx2")))
+double minF64AVX2(double *a, int64_t n) {
+    __m256d min = _mm256_set1_pd(a[0]);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        min = _mm256_or_pd(_mm256_min_pd(x, min), _mm256_and_pd(x, _mm256_cmp_pd(x, min, _CMP_EQ_OQ)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, min);
+    double result = minF64Scalar(lanes, 4);
+    for (; i < n; i++) {
+        result = lesserF64(a[i], result);
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+double maxF64AVX2(double *a, int64_t n) {
+    __m256d max = _mm256_set1_pd(a[0]);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        max = _mm256_and_pd(_mm256_max_pd(x, max), _mm256_or_pd(x, _mm256_cmp_pd(x, max, _CMP_NEQ_UQ)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, max);
+    double result = maxF64Scalar(lanes, 4);
+    for (; i < n; i++) {
+        result = greaterF64(a[i], result);
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+double dotF64AVX2(double *a, double *b, int64_t n) {
+    __m256d sum = _mm256_setzero_pd();
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotF64Scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+int64_t sumS64AVX2(int64_t *a, int64_t n) {
+    __m256i sum = _mm256_setzero_si256();
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum = _mm256_add_epi64(sum, _mm256_loadu_si256((__m256i *)(a + i)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    return (int64_t)((uint64_t)sumS64Scalar(lanes, 4) + (uint64_t)sumS64Scalar(a + i, n - i));
+}
+
+__attribute__((target("avx2")))
+int64_t minS64AVX2(int64_t *a, int64_t n) {
+    __m256i min = _mm256_set1_epi64x(a[0]);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        min = _mm256_blendv_epi8(min, x, _mm256_cmpgt_epi64(min, x));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, min);
+    int64_t result = minS64Scalar(lanes, 4);
+    int64_t rest = i < n ? minS64Scalar(a + i, n - i) : result;
+    return rest < result ? rest : result;
+}
+
+__attribute__((target("avx2")))
+int64_t maxS64AVX2(int64_t *a, int64_t n) {
+    __m256i max = _mm256_set1_epi64x(a[0]);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        max = _mm256_blendv_epi8(max, x, _mm256_cmpgt_epi64(x, max));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, max);
+    int64_t result = maxS64Scalar(lanes, 4);
+    int64_t rest = i < n ? maxS64Scalar(a + i, n - i) : result;
+    return rest > result ? rest : result;
+}
+
+// Each group of four is summed in its register in two steps, adding it to
+// itself shifted up by one element and then by two, and the total so far is
+// then added to all four.
+__attribute__((target("avx2")))
+void scanF64AVX2(double *out, double *a, int64_t n) {
+    __m256d zero = _mm256_setzero_pd();
+    __m256d carry = zero;
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 1));
+        x = _mm256_add_pd(x, _mm256_permute2f128_pd(x, x, 0x08));
+        x = _mm256_add_pd(x, carry);
+        _mm256_storeu_pd(out + i, x);
+        carry = _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    double total = _mm256_cvtsd_f64(carry);
+    for (; i < n; i++) {
+        total += a[i];
+        out[i] = total;
+    }
+}
+
+// Marks the characters from low to high in c with 0xff.
+__attribute__((target("avx2")))
+__m256i inRangeAVX2(__m256i c, char low, char high) {
+    __m256i offset = _mm256_sub_epi8(c, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(high - low)), offset);
+}
+
+// Classifies 32 characters at once.
+__attribute__((target("avx2")))
+CharMasks classifyCharsAVX2(char *text) {
+    __m256i c = _mm256_loadu_si256((__m256i *)text);
+    __m256i whitespace = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+                                         inRangeAVX2(c, '\t', '\r'));
+    __m256i delimiters = _mm256_or_si256(whitespace, inRangeAVX2(c, '\'', ')'));
+    delimiters = _mm256_or_si256(delimiters, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('[')));
+    delimiters = _mm256_or_si256(delimiters, _mm256_cmpeq_epi8(c, _mm256_set1_epi8(']')));
+    delimiters = _mm256_or_si256(delimiters, _mm256_cmpeq_epi8(c, _mm256_set1_epi8(';')));
+    __m256i symbols = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('!')),
+                                      _mm256_cmpeq_epi8(c, _mm256_set1_epi8('~')));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, '$', '&'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, '*', '+'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, '-', ':'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, '<', '?'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, 'A', 'Z'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, '^', '_'));
+    symbols = _mm256_or_si256(symbols, inRangeAVX2(c, 'a', 'z'));
+    CharMasks masks;
+    masks.whitespace = (uint32_t)_mm256_movemask_epi8(whitespace);
+    masks.delimiters = (uint32_t)_mm256_movemask_epi8(delimiters);
+    masks.digits = (uint32_t)_mm256_movemask_epi8(inRangeAVX2(c, '0', '9'));
+    masks.symbols = (uint32_t)_mm256_movemask_epi8(symbols);
+    return masks;
+}
+
+#endif
+
+// The kernel sets, from least to most capable.
+Kernels scalarKernels = {
+    .name = "scalar",
+    .mapF64 = mapF64Scalar, .mapS64 = mapS64Scalar,
+    .sumF64 = sumF64Scalar, .minF64 = minF64Scalar, .maxF64 = maxF64Scalar, .dotF64 = dotF64Scalar,
+    .sumS64 = sumS64Scalar, .minS64 = minS64Scalar, .maxS64 = maxS64Scalar, .dotS64 = dotS64Scalar,
+    .scanF64 = scanF64Scalar, .scanS64 = scanS64Scalar,
+    .classifyChars = classifyCharsScalar
+};
+
+#ifdef X86_KERNELS
+Kernels sse2Kernels = {
+    .name = "sse2",
+    .mapF64 = mapF64SSE2, .mapS64 = mapS64SSE2,
+    .sumF64 = sumF64SSE2, .minF64 = minF64SSE2, .maxF64 = maxF64SSE2, .dotF64 = dotF64SSE2,
+    .sumS64 = sumS64SSE2, .minS64 = minS64Scalar, .maxS64 = maxS64Scalar, .dotS64 = dotS64Scalar,
+    .scanF64 = scanF64SSE2, .scanS64 = scanS64Scalar,
+    .classifyChars = classifyCharsSSE2
+};
+
+Kernels avx2Kernels = {
+    .name = "avx2",
+    .mapF64 = mapF64AVX2, .mapS64 = mapS64AVX2,
+    .sumF64 = sumF64AVX2, .minF64 = minF64AVX2, .maxF64 = maxF64AVX2, .dotF64 = dotF64AVX2,
+    .sumS64 = sumS64AVX2, .minS64 = minS64AVX2, .maxS64 = maxS64AVX2, .dotS64 = dotS64Scalar,
+    .scanF64 = scanF64AVX2, .scanS64 = scanS64Scalar,
+    .classifyChars = classifyCharsAVX2
+};
+
+Kernels *kernelSets[] = {&scalarKernels, &sse2Kernels, &avx2Kernels};
+#else
+Kernels *kernelSets[] = {&scalarKernels};
+#endif
+
+Kernels *kernels = NULL;
+
+// Whether the CPU can run a set of kernels.
+bool supportsKernels(Kernels *set) {
+#ifdef X86_KERNELS
+    __builtin_cpu_init();
+    if (set == &sse2Kernels) {
+        return __builtin_cpu_supports("sse2");
+    }
+    if (set == &avx2Kernels) {
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return set == &scalarKernels;
+}
+
+// Returns the kernels for the best instruction set the CPU supports, or for
+// the one named by selectKernels.
+Kernels *getKernels() {
+    if (kernels == NULL) {
+        int count = sizeof(kernelSets) / sizeof(kernelSets[0]);
+        for (int i = 0; i < count; i++) {
+            if (supportsKernels(kernelSets[i])) {
+                kernels = kernelSets[i];
+            }
+        }
+    }
+    return kernels;
+}
+
+// Limits the kernels to the named instruction set, if the CPU supports it.
+bool selectKernels(char *name) {
+    int count = sizeof(kernelSets) / sizeof(kernelSets[0]);
+    for (int i = 0; i < count; i++) {
+        if (!strcmp(kernelSets[i]->name, name) && supportsKernels(kernelSets[i])) {
+            kernels = kernelSets[i];
+            return true;
+        }
+    }
+    return false;
+}
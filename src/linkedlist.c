@@ -5,18 +5,23 @@
 #include "value.h"
 #include "assert.h"
 #include "talloc.h"
+#include "str.h"
 
-// Create a new NULL_TYPE value node.
+// Return the NULL_TYPE value. It is an immediate, so nothing is allocated.
 Value *makeNull() {
-    Value *val = talloc(sizeof(Value));
-    val->type = NULL_TYPE;
-    //val->marked = false;
+    return NULL_VALUE;
+}
+
+// Create a new boxed value node of the given type.
+Value *makeValue(valueType type) {
+    Value *val = tallocKind(sizeof(Value), VALUE_KIND);
+    val->type = type;
     return val;
 }
 
 // Create a new CONS_TYPE value node.
 Value *cons(Value *newCar, Value *newCdr) {
-    Value *node = talloc(sizeof(Value));
+    Value *node = tallocKind(sizeof(Value), VALUE_KIND);
     node->type = CONS_TYPE;
     //node->marked = false;
     node->c.car = newCar;
@@ -29,17 +34,18 @@ Value *cons(Value *newCar, Value *newCdr) {
 void display(Value *list) {
     printf("(");
     Value *testList = list;
-    while (testList->type == CONS_TYPE) {
+    while (typeOf(testList) == CONS_TYPE) {
         Value *listCar = testList->c.car;
-        switch (testList->c.car->type) {
+        switch (typeOf(testList->c.car)) {
             case INT_TYPE:
-                printf("%i ", listCar->i);
+                printf("%i ", intValue(listCar));
                 break;
             case DOUBLE_TYPE:
                 printf("%f ", listCar->d);
                 break;
             case STR_TYPE:
-                printf("%s ", listCar->s);
+                writeString(listCar, true);
+                printf(" ");
                 break;
             case CONS_TYPE:
                 display(listCar);
@@ -54,16 +60,18 @@ void display(Value *list) {
                 break;
         }
         testList = testList->c.cdr;
-        if (testList->type != NULL_TYPE) {
-            switch (testList->type) {
+        if (typeOf(testList) != NULL_TYPE) {
+            switch (typeOf(testList)) {
                 case INT_TYPE:
-                    printf(". %i ", testList->i);
+                    printf(". %i ", intValue(testList));
                     break;
                 case DOUBLE_TYPE:
                     printf(". %f ", testList->d);
                     break;
                 case STR_TYPE:
-                    printf(". %s ", testList->s);
+                    printf(". ");
+                    writeString(testList, true);
+                    printf(" ");
                     break;
                 case NULL_TYPE:
                     printf(". () ");
@@ -84,17 +92,9 @@ void display(Value *list) {
 Value *reverse(Value *list) {
     Value *prev = makeNull();
     Value *current = list;
-    Value *next = cdr(list);
-    Value *new;
-    while(current->type != NULL_TYPE) {
-        new = cons(car(current), prev);
-        prev = new;
-        current = next;
-        if (current->type == NULL_TYPE) {
-            break;
-        } else {
-            next = cdr(next);
-        }
+    while (typeOf(current) != NULL_TYPE) {
+        prev = cons(car(current), prev);
+        current = cdr(current);
     }
     return prev;
 }
@@ -114,7 +114,7 @@ Value *cdr(Value *list) {
 // Utility to check if pointing to a NULL_TYPE value.
 bool isNull(Value *value) {
     assert(value != NULL);
-    return value->type == NULL_TYPE;
+    return typeOf(value) == NULL_TYPE;
 }
 
 // Measure length of list.
@@ -122,9 +122,9 @@ int length(Value *value) {
     assert(value != NULL);
     int length = 0;
     Value *nextNode = value;
-    while (nextNode->type != NULL_TYPE)
+    while (typeOf(nextNode) != NULL_TYPE)
     {
-        if (nextNode->type == CONS_TYPE) {
+        if (typeOf(nextNode) == CONS_TYPE) {
             nextNode = cdr(nextNode);
             ++length;
         } else {
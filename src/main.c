@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "tokenizer.h"
 #include "value.h"
@@ -6,21 +7,52 @@
 #include "talloc.h"
 #include "parser.h"
 #include "interpreter.h"
+#include "vm.h"
+#include "kernels.h"
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
+// Interprets the input file named on the command line, reading and running
+// one top-level form at a time.
+// With --vm before the file name, the program is compiled to bytecode and run
+// by the VM rather than by the tree-walking evaluator. The VM keeps its calls
+// on a stack of its own, so non-tail recursion can go as deep as STACK_LIMIT
+// allows rather than as deep as the C stack does.
+int run(int argc, char *argv[]) {
+    bool compiled = argc == 3 && !strcmp(argv[1], "--vm");
+    if (argc != 2 && !compiled) {
         printf("Invalid number of arguments: supply (only) name of input file");
         texit(1);
     }
-    char *inputFileName = argv[1];
+    char *inputFileName = argv[argc - 1];
     char fullInputPath[2000];
     strcpy(fullInputPath, "../inputfiles/");
     strcat(fullInputPath, inputFileName);
     printf("Input filename is %s\n", fullInputPath);
 
-    Value *list = tokenize(fullInputPath);
-    Value *tree = parse(list);
-    interpret(tree);
+    Source *source = openSource(fullInputPath);
+    interpret(source, compiled);
+    closeSource(source);
 
     tfree();
+    return 0;
+}
+
+// The GC_THRESHOLD environment variable sets how many bytes are allocated
+// between garbage collections, and STACK_LIMIT how many bytes the VM's stacks
+// may grow to. SIMD names the instruction set the numeric vector kernels are
+// limited to (scalar, sse2 or avx2) instead of the best one the CPU has.
+int main(int argc, char *argv[]) {
+    char *threshold = getenv("GC_THRESHOLD");
+    if (threshold != NULL) {
+        tsetthreshold(strtoul(threshold, NULL, 10));
+    }
+    char *limit = getenv("STACK_LIMIT");
+    if (limit != NULL) {
+        setStackLimit(strtoul(limit, NULL, 10));
+    }
+    char *simd = getenv("SIMD");
+    if (simd != NULL && !selectKernels(simd)) {
+        printf("SIMD: %s is not supported here\n", simd);
+        return 1;
+    }
+    return tmain(run, argc, argv);
 }
@@ -0,0 +1,469 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "value.h"
+#include "numvector.h"
+#include "kernels.h"
+#include "bignum.h"
+#include "interpreter.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// The f64vector and s64vector primitives. Both kinds of vector keep their
+// elements unboxed in one atomic block, so whole-vector operations are loops
+// over plain arrays, which are left to the kernels in kernels.h. The
+// primitives for the two kinds differ only in their element type, so each is
+// a thin wrapper that passes its name and vector type to a shared function.
+// Element-wise arithmetic takes two vectors of the same length, or a vector
+// and a number that is used with every element. s64vector arithmetic wraps
+// around on overflow.
+
+// One element of either kind of vector.
+typedef union {
+    double d;
+    int64_t i;
+} Element;
+
+// Returns a new vector of the given type with count elements, all zero.
+Value *makeNumericVector(valueType type, int64_t count) {
+    void *elements = tallocKind(sizeof(Element) * count, ATOMIC_KIND);
+    Value *vector = makeValue(type);
+    vector->nv.elements = elements;
+    vector->nv.count = count;
+    return vector;
+}
+
+// Exits unless value is a vector of the given type.
+void checkVector(char *name, valueType type, Value *value) {
+    if (typeOf(value) != type) {
+        printf("%s: contract violation\n"
+               "  expected: %s?", name, type == F64VECTOR_TYPE ? "f64vector" : "s64vector");
+        texit(1);
+    }
+}
+
+// Exits unless two vectors have the same length.
+void checkLengths(char *name, Value *a, Value *b) {
+    if (a->nv.count != b->nv.count) {
+        printf("%s: vectors have different lengths", name);
+        texit(1);
+    }
+}
+
+// Exits unless index is a valid index into vector.
+void checkIndex(char *name, Value *vector, Value *index) {
+    if (typeOf(index) != INT_TYPE || intValue(index) < 0 || intValue(index) >= vector->nv.count) {
+        printf("%s: index is out of range", name);
+        texit(1);
+    }
+}
+
+// Exits unless vector has at least one element.
+void checkNotEmpty(char *name, Value *vector) {
+    if (vector->nv.count == 0) {
+        printf("%s: contract violation\n"
+               "  expected: non-empty vector", name);
+        texit(1);
+    }
+}
+
+// Converts a Value to an element of a vector of the given type, exiting if
+// it can't be one.
+Element toElement(char *name, valueType type, Value *value) {
+    Element element;
+    if (type == F64VECTOR_TYPE) {
+        if (!isNumber(value)) {
+            printf("%s: contract violation\n"
+                   "  expected: real?", name);
+            texit(1);
+        }
+        element.d = toDouble(value);
+    }
+    else if (!isInteger(value) || !integerToInt64(value, &element.i)) {
+        printf("%s: contract violation\n"
+               "  expected: (integer-in -9223372036854775808 9223372036854775807)", name);
+        texit(1);
+    }
+    return element;
+}
+
+// Returns an element of a vector as a Value.
+Value *fromElement(valueType type, Element element) {
+    if (type == F64VECTOR_TYPE) {
+        Value *value = makeValue(DOUBLE_TYPE);
+        value->d = element.d;
+        return value;
+    }
+    return makeInteger(element.i);
+}
+
+// (make-f64vector n [fill]) and (make-s64vector n [fill]).
+Value *makeVectorOf(char *name, valueType type, int argc, Value **argv) {
+    if (typeOf(argv[0]) != INT_TYPE || intValue(argv[0]) < 0) {
+        printf("%s: contract violation\n"
+               "  expected: exact-nonnegative-integer?", name);
+        texit(1);
+    }
+    Element fill = {0};
+    if (argc == 2) {
+        fill = toElement(name, type, argv[1]);
+    }
+    Value *vector = makeNumericVector(type, intValue(argv[0]));
+    Element *elements = vector->nv.elements;
+    if (fill.i != 0) {
+        for (int64_t i = 0; i < vector->nv.count; i++) {
+            elements[i] = fill;
+        }
+    }
+    return vector;
+}
+
+// (f64vector x ...) and (s64vector x ...).
+Value *vectorOf(char *name, valueType type, int argc, Value **argv) {
+    Element *elements = tallocKind(sizeof(Element) * argc, ATOMIC_KIND);
+    for (int i = 0; i < argc; i++) {
+        elements[i] = toElement(name, type, argv[i]);
+    }
+    Value *vector = makeValue(type);
+    vector->nv.elements = elements;
+    vector->nv.count = argc;
+    return vector;
+}
+
+// (list->f64vector list) and (list->s64vector list).
+Value *listToVector(char *name, valueType type, Value *list) {
+    int64_t count = 0;
+    Value *current = list;
+    while (typeOf(current) == CONS_TYPE) {
+        count++;
+        current = cdr(current);
+    }
+    if (typeOf(current) != NULL_TYPE) {
+        printf("%s: contract violation\n"
+               "  expected: list?", name);
+        texit(1);
+    }
+    Value *vector = makeNumericVector(type, count);
+    Element *elements = vector->nv.elements;
+    for (int64_t i = 0; i < count; i++) {
+        elements[i] = toElement(name, type, car(list));
+        list = cdr(list);
+    }
+    return vector;
+}
+
+// (f64vector->list v) and (s64vector->list v). The list is built from the
+// end, so each element's Value is made before the cell that holds it.
+Value *vectorToList(char *name, valueType type, Value *vector) {
+    checkVector(name, type, vector);
+    Value *list = makeNull();
+    for (int64_t i = vector->nv.count - 1; i >= 0; i--) {
+        Element *elements = vector->nv.elements;
+        list = cons(fromElement(type, elements[i]), list);
+    }
+    return list;
+}
+
+// (f64vector-length v) and (s64vector-length v).
+Value *vectorLength(char *name, valueType type, Value *vector) {
+    checkVector(name, type, vector);
+    return makeInteger(vector->nv.count);
+}
+
+// (f64vector-ref v i) and (s64vector-ref v i).
+Value *vectorRef(char *name, valueType type, Value **argv) {
+    checkVector(name, type, argv[0]);
+    checkIndex(name, argv[0], argv[1]);
+    Element *elements = argv[0]->nv.elements;
+    return fromElement(type, elements[intValue(argv[1])]);
+}
+
+// (f64vector-set! v i x) and (s64vector-set! v i x).
+Value *vectorSet(char *name, valueType type, Value **argv) {
+    checkVector(name, type, argv[0]);
+    checkIndex(name, argv[0], argv[1]);
+    Element *elements = argv[0]->nv.elements;
+    elements[intValue(argv[1])] = toElement(name, type, argv[2]);
+    return VOID_VALUE;
+}
+
+// Element-wise arithmetic: (f64vector+ v w), (s64vector* v 3) and so on.
+Value *vectorMap(char *name, valueType type, kernelOp op, Value **argv) {
+    checkVector(name, type, argv[0]);
+    bool scalar = typeOf(argv[1]) != type;
+    Element operand;
+    if (scalar) {
+        operand = toElement(name, type, argv[1]);
+    }
+    else {
+        checkLengths(name, argv[0], argv[1]);
+    }
+    Value *result = makeNumericVector(type, argv[0]->nv.count);
+    void *other = scalar ? (void *)&operand : argv[1]->nv.elements;
+    if (type == F64VECTOR_TYPE) {
+        getKernels()->mapF64(op, result->nv.elements, argv[0]->nv.elements, other, scalar, result->nv.count);
+    }
+    else {
+        getKernels()->mapS64(op, result->nv.elements, argv[0]->nv.elements, other, scalar, result->nv.count);
+    }
+    return result;
+}
+
+// (f64vector-sum v) and (s64vector-sum v).
+Value *vectorSum(char *name, valueType type, Value *vector) {
+    checkVector(name, type, vector);
+    Element sum;
+    if (type == F64VECTOR_TYPE) {
+        sum.d = getKernels()->sumF64(vector->nv.elements, vector->nv.count);
+    }
+    else {
+        sum.i = getKernels()->sumS64(vector->nv.elements, vector->nv.count);
+    }
+    return fromElement(type, sum);
+}
+
+// (f64vector-min v), (f64vector-max v) and the same for s64vectors; max is
+// set for the max ones.
+Value *vectorExtreme(char *name, valueType type, bool max, Value *vector) {
+    checkVector(name, type, vector);
+    checkNotEmpty(name, vector);
+    Kernels *kernels = getKernels();
+    Element extreme;
+    if (type == F64VECTOR_TYPE) {
+        extreme.d = (max ? kernels->maxF64 : kernels->minF64)(vector->nv.elements, vector->nv.count);
+    }
+    else {
+        extreme.i = (max ? kernels->maxS64 : kernels->minS64)(vector->nv.elements, vector->nv.count);
+    }
+    return fromElement(type, extreme);
+}
+
+// (f64vector-dot v w) and (s64vector-dot v w), the sum of the products of
+// their elements.
+Value *vectorDot(char *name, valueType type, Value **argv) {
+    checkVector(name, type, argv[0]);
+    checkVector(name, type, argv[1]);
+    checkLengths(name, argv[0], argv[1]);
+    Element dot;
+    if (type == F64VECTOR_TYPE) {
+        dot.d = getKernels()->dotF64(argv[0]->nv.elements, argv[1]->nv.elements, argv[0]->nv.count);
+    }
+    else {
+        dot.i = getKernels()->dotS64(argv[0]->nv.elements, argv[1]->nv.elements, argv[0]->nv.count);
+    }
+    return fromElement(type, dot);
+}
+
+// (f64vector-scan v) and (s64vector-scan v), a new vector of the running
+// totals of v's elements.
+Value *vectorScan(char *name, valueType type, Value *vector) {
+    checkVector(name, type, vector);
+    Value *result = makeNumericVector(type, vector->nv.count);
+    if (type == F64VECTOR_TYPE) {
+        getKernels()->scanF64(result->nv.elements, vector->nv.elements, vector->nv.count);
+    }
+    else {
+        getKernels()->scanS64(result->nv.elements, vector->nv.elements, vector->nv.count);
+    }
+    return result;
+}
+
+// Primitive wrappers for f64vectors.
+
+Value *primitiveMakeF64Vector(int argc, Value **argv) {
+    return makeVectorOf("make-f64vector", F64VECTOR_TYPE, argc, argv);
+}
+
+Value *primitiveF64Vector(int argc, Value **argv) {
+    return vectorOf("f64vector", F64VECTOR_TYPE, argc, argv);
+}
+
+Value *primitiveListToF64Vector(int argc, Value **argv) {
+    return listToVector("list->f64vector", F64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveF64VectorToList(int argc, Value **argv) {
+    return vectorToList("f64vector->list", F64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveF64VectorLength(int argc, Value **argv) {
+    return vectorLength("f64vector-length", F64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveF64VectorRef(int argc, Value **argv) {
+    return vectorRef("f64vector-ref", F64VECTOR_TYPE, argv);
+}
+
+Value *primitiveF64VectorSet(int argc, Value **argv) {
+    return vectorSet("f64vector-set!", F64VECTOR_TYPE, argv);
+}
+
+Value *primitiveF64VectorAdd(int argc, Value **argv) {
+    return vectorMap("f64vector+", F64VECTOR_TYPE, KERNEL_ADD, argv);
+}
+
+Value *primitiveF64VectorSubtract(int argc, Value **argv) {
+    return vectorMap("f64vector-", F64VECTOR_TYPE, KERNEL_SUBTRACT, argv);
+}
+
+Value *primitiveF64VectorMultiply(int argc, Value **argv) {
+    return vectorMap("f64vector*", F64VECTOR_TYPE, KERNEL_MULTIPLY, argv);
+}
+
+Value *primitiveF64VectorDivide(int argc, Value **argv) {
+    return vectorMap("f64vector/", F64VECTOR_TYPE, KERNEL_DIVIDE, argv);
+}
+
+Value *primitiveF64VectorSum(int argc, Value **argv) {
+    return vectorSum("f64vector-sum", F64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveF64VectorMin(int argc, Value **argv) {
+    return vectorExtreme("f64vector-min", F64VECTOR_TYPE, false, argv[0]);
+}
+
+Value *primitiveF64VectorMax(int argc, Value **argv) {
+    return vectorExtreme("f64vector-max", F64VECTOR_TYPE, true, argv[0]);
+}
+
+Value *primitiveF64VectorDot(int argc, Value **argv) {
+    return vectorDot("f64vector-dot", F64VECTOR_TYPE, argv);
+}
+
+Value *primitiveF64VectorScan(int argc, Value **argv) {
+    return vectorScan("f64vector-scan", F64VECTOR_TYPE, argv[0]);
+}
+
+// Primitive wrappers for s64vectors. There is no s64vector/.
+
+Value *primitiveMakeS64Vector(int argc, Value **argv) {
+    return makeVectorOf("make-s64vector", S64VECTOR_TYPE, argc, argv);
+}
+
+Value *primitiveS64Vector(int argc, Value **argv) {
+    return vectorOf("s64vector", S64VECTOR_TYPE, argc, argv);
+}
+
+Value *primitiveListToS64Vector(int argc, Value **argv) {
+    return listToVector("list->s64vector", S64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveS64VectorToList(int argc, Value **argv) {
+    return vectorToList("s64vector->list", S64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveS64VectorLength(int argc, Value **argv) {
+    return vectorLength("s64vector-length", S64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveS64VectorRef(int argc, Value **argv) {
+    return vectorRef("s64vector-ref", S64VECTOR_TYPE, argv);
+}
+
+Value *primitiveS64VectorSet(int argc, Value **argv) {
+    return vectorSet("s64vector-set!", S64VECTOR_TYPE, argv);
+}
+
+Value *primitiveS64VectorAdd(int argc, Value **argv) {
+    return vectorMap("s64vector+", S64VECTOR_TYPE, KERNEL_ADD, argv);
+}
+
+Value *primitiveS64VectorSubtract(int argc, Value **argv) {
+    return vectorMap("s64vector-", S64VECTOR_TYPE, KERNEL_SUBTRACT, argv);
+}
+
+Value *primitiveS64VectorMultiply(int argc, Value **argv) {
+    return vectorMap("s64vector*", S64VECTOR_TYPE, KERNEL_MULTIPLY, argv);
+}
+
+Value *primitiveS64VectorSum(int argc, Value **argv) {
+    return vectorSum("s64vector-sum", S64VECTOR_TYPE, argv[0]);
+}
+
+Value *primitiveS64VectorMin(int argc, Value **argv) {
+    return vectorExtreme("s64vector-min", S64VECTOR_TYPE, false, argv[0]);
+}
+
+Value *primitiveS64VectorMax(int argc, Value **argv) {
+    return vectorExtreme("s64vector-max", S64VECTOR_TYPE, true, argv[0]);
+}
+
+Value *primitiveS64VectorDot(int argc, Value **argv) {
+    return vectorDot("s64vector-dot", S64VECTOR_TYPE, argv);
+}
+
+Value *primitiveS64VectorScan(int argc, Value **argv) {
+    return vectorScan("s64vector-scan", S64VECTOR_TYPE, argv[0]);
+}
+
+// Binds the f64vector and s64vector primitives as global variables.
+void bindNumericVectors() {
+    bind("make-f64vector", primitiveMakeF64Vector, 1, 2);
+    bind("f64vector", primitiveF64Vector, 0, -1);
+    bind("list->f64vector", primitiveListToF64Vector, 1, 1);
+    bind("f64vector->list", primitiveF64VectorToList, 1, 1);
+    bind("f64vector-length", primitiveF64VectorLength, 1, 1);
+    bind("f64vector-ref", primitiveF64VectorRef, 2, 2);
+    bind("f64vector-set!", primitiveF64VectorSet, 3, 3);
+    bind("f64vector+", primitiveF64VectorAdd, 2, 2);
+    bind("f64vector-", primitiveF64VectorSubtract, 2, 2);
+    bind("f64vector*", primitiveF64VectorMultiply, 2, 2);
+    bind("f64vector/", primitiveF64VectorDivide, 2, 2);
+    bind("f64vector-sum", primitiveF64VectorSum, 1, 1);
+    bind("f64vector-min", primitiveF64VectorMin, 1, 1);
+    bind("f64vector-max", primitiveF64VectorMax, 1, 1);
+    bind("f64vector-dot", primitiveF64VectorDot, 2, 2);
+    bind("f64vector-scan", primitiveF64VectorScan, 1, 1);
+
+    bind("make-s64vector", primitiveMakeS64Vector, 1, 2);
+    bind("s64vector", primitiveS64Vector, 0, -1);
+    bind("list->s64vector", primitiveListToS64Vector, 1, 1);
+    bind("s64vector->list", primitiveS64VectorToList, 1, 1);
+    bind("s64vector-length", primitiveS64VectorLength, 1, 1);
+    bind("s64vector-ref", primitiveS64VectorRef, 2, 2);
+    bind("s64vector-set!", primitiveS64VectorSet, 3, 3);
+    bind("s64vector+", primitiveS64VectorAdd, 2, 2);
+    bind("s64vector-", primitiveS64VectorSubtract, 2, 2);
+    bind("s64vector*", primitiveS64VectorMultiply, 2, 2);
+    bind("s64vector-sum", primitiveS64VectorSum, 1, 1);
+    bind("s64vector-min", primitiveS64VectorMin, 1, 1);
+    bind("s64vector-max", primitiveS64VectorMax, 1, 1);
+    bind("s64vector-dot", primitiveS64VectorDot, 2, 2);
+    bind("s64vector-scan", primitiveS64VectorScan, 1, 1);
+}
+
+// Whether two numeric vectors of the same type have equal elements.
+bool numericVectorsEqual(Value *a, Value *b) {
+    if (a->nv.count != b->nv.count) {
+        return false;
+    }
+    if (typeOf(a) == S64VECTOR_TYPE) {
+        return !memcmp(a->nv.elements, b->nv.elements, sizeof(Element) * a->nv.count);
+    }
+    double *x = a->nv.elements;
+    double *y = b->nv.elements;
+    for (int64_t i = 0; i < a->nv.count; i++) {
+        if (x[i] != y[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Prints a numeric vector, as #f64(...) or #s64(...).
+void printNumericVector(Value *vector) {
+    printf(typeOf(vector) == F64VECTOR_TYPE ? "#f64(" : "#s64(");
+    Element *elements = vector->nv.elements;
+    for (int64_t i = 0; i < vector->nv.count; i++) {
+        if (i > 0) {
+            printf(" ");
+        }
+        if (typeOf(vector) == F64VECTOR_TYPE) {
+            printf("%f", elements[i].d);
+        }
+        else {
+            printf("%" PRId64, elements[i].i);
+        }
+    }
+    printf(")");
+}
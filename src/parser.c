@@ -6,30 +6,39 @@
 #include "talloc.h"
 #include "assert.h"
 #include "parser.h"
+#include "bignum.h"
+#include "numvector.h"
+#include "vector.h"
+#include "hashtable.h"
+#include "str.h"
 
 
 // Add the next token in the sequence to the parse tree (stack), creates subTrees when a close
-// bracket or parentheses is found.
+// bracket or parentheses is found. A parenthesis that closes a #( makes a vector instead of a
+// list.
 Value *addToParseTree(Value *tree, int *depth, int *depthB, Value *token) {
-    if (token->type == CLOSE_TYPE && *depth != 0) {
+    if (typeOf(token) == CLOSE_TYPE && *depth != 0) {
         *depth -= 1;
         Value *subTree = makeNull();
-        while (car(tree)->type != OPEN_TYPE) {
+        while (typeOf(car(tree)) != OPEN_TYPE && typeOf(car(tree)) != OPEN_VECTOR_TYPE) {
             subTree = cons(car(tree), subTree);
             tree = cdr(tree);
         }
+        if (typeOf(car(tree)) == OPEN_VECTOR_TYPE) {
+            subTree = vectorFromList(subTree);
+        }
         tree = cdr(tree);
         tree = cons(subTree, tree);
         return tree;
     }
-    else if (token->type == CLOSE_TYPE && *depth == 0){
+    else if (typeOf(token) == CLOSE_TYPE && *depth == 0){
         printf("Syntax Error: Too many close parentheses.");
         texit(1);
     }
-    else if (token->type == CLOSE_BRACKET_TYPE && *depthB != 0) {
+    else if (typeOf(token) == CLOSE_BRACKET_TYPE && *depthB != 0) {
         *depthB -= 1;
         Value *subTree = makeNull();
-        while (car(tree)->type != OPEN_BRACKET_TYPE) {
+        while (typeOf(car(tree)) != OPEN_BRACKET_TYPE) {
             subTree = cons(car(tree), subTree);
             tree = cdr(tree);
         }
@@ -37,15 +46,15 @@ Value *addToParseTree(Value *tree, int *depth, int *depthB, Value *token) {
         tree = cons(subTree, tree);
         return tree;
     }
-    else if (token->type == CLOSE_BRACKET_TYPE && *depthB == 0){
+    else if (typeOf(token) == CLOSE_BRACKET_TYPE && *depthB == 0){
         printf("Syntax Error: Too many close brackets.");
         texit(1);
     }
-    else if (token->type == OPEN_TYPE) {
+    else if (typeOf(token) == OPEN_TYPE || typeOf(token) == OPEN_VECTOR_TYPE) {
         *depth += 1;
         return cons(token, tree);
     }
-    else if (token->type == OPEN_BRACKET_TYPE) {
+    else if (typeOf(token) == OPEN_BRACKET_TYPE) {
         *depthB += 1;
         return cons(token, tree);
     }
@@ -59,7 +68,7 @@ Value *parse(Value *tokens) {
     int depthB = 0;
     Value *current = tokens;
     assert(current != NULL && "Error (parse): null pointer");
-    while (current->type != NULL_TYPE) {
+    while (typeOf(current) != NULL_TYPE) {
         Value *token = car(current);
         tree = addToParseTree(tree, &depth, &depthB, token);
         current = cdr(current);
@@ -76,13 +85,37 @@ Value *parse(Value *tokens) {
     return tree;
 }
 
+// Reads the next top-level datum from a source, taking only the tokens it is
+// made of, and returns its parse tree. Returns NULL at the end of the source.
+Value *readDatum(Source *source) {
+    Value *tree = makeNull();
+    int depth = 0;
+    int depthB = 0;
+    do {
+        Value *token = nextToken(source);
+        if (token == NULL) {
+            if (depth != 0) {
+                printf("Syntax Error: Not enough close parentheses.");
+                texit(1);
+            }
+            else if (depthB != 0) {
+                printf("Syntax Error: Not enough close brackets.");
+                texit(1);
+            }
+            return NULL;
+        }
+        tree = addToParseTree(tree, &depth, &depthB, token);
+    } while (depth != 0 || depthB != 0);
+    return car(tree);
+}
+
 //// Prints the tree to the screen in a readable fashion. It should look just like
 //// Racket code; use parentheses to indicate subtrees.
 //void printTree(Value *tree) {
-//    if(tree->type != CONS_TYPE) {
-//        switch (tree->type) {
+//    if(typeOf(tree) != CONS_TYPE) {
+//        switch (typeOf(tree)) {
 //            case INT_TYPE:
-//                printf("%i", tree->i);
+//                printf("%i", intValue(tree));
 //                break;
 //            case DOUBLE_TYPE:
 //                printf("%f", tree->d);
@@ -105,15 +138,15 @@ Value *parse(Value *tokens) {
 //    }
 //
 //    Value *newTree = tree;
-//    while (newTree->type == CONS_TYPE) {
+//    while (typeOf(newTree) == CONS_TYPE) {
 //        printf("(");
 //        Value *carTree = car(newTree);
-//        switch (carTree->type) {
+//        switch (typeOf(carTree)) {
 //            case CONS_TYPE:
 //                printTree(carTree);
 //                break;
 //            case INT_TYPE:
-//                printf("%i", carTree->i);
+//                printf("%i", intValue(carTree));
 //                break;
 //            case DOUBLE_TYPE:
 //                printf("%f", carTree->d);
@@ -136,7 +169,7 @@ Value *parse(Value *tokens) {
 //                break;
 //        }
 //        newTree = cdr(newTree);
-//        if (newTree->type != NULL_TYPE && carTree->type != SINGLE_QUOTE_TYPE) {
+//        if (typeOf(newTree) != NULL_TYPE && typeOf(carTree) != SINGLE_QUOTE_TYPE) {
 //            printf(" ");
 //        }
 //    }
@@ -145,10 +178,35 @@ Value *parse(Value *tokens) {
 
 // Print the Value of a single token
 void printToken(Value *token) {
-    valueType type = token->type;
+    valueType type = typeOf(token);
     switch(type) {
         case INT_TYPE:
-            printf("%i", token->i);
+            printf("%i", intValue(token));
+            break;
+        case BIGNUM_TYPE:
+            printInteger(token);
+            break;
+        case VECTOR_TYPE:
+            printf("#(");
+            for (int64_t i = 0; i < token->vec.count; i++) {
+                if (i > 0) {
+                    printf(" ");
+                }
+                printTree(token->vec.items[i]);
+            }
+            printf(")");
+            break;
+        case F64VECTOR_TYPE:
+        case S64VECTOR_TYPE:
+            printNumericVector(token);
+            break;
+        case HASH_TABLE_TYPE:
+            printHashTable(token);
+            break;
+        case RATIONAL_TYPE:
+            printInteger(token->rat.numerator);
+            printf("/");
+            printInteger(token->rat.denominator);
             break;
         case DOUBLE_TYPE:
             printf("%f", token->d);
@@ -157,10 +215,10 @@ void printToken(Value *token) {
             printf("%s", token->s);
             break;
         case STR_TYPE:
-            printf("%s", token->s);
+            writeString(token, true);
             break;
         case BOOL_TYPE:
-            printf("%s", token->s);
+            printf("%s", token == TRUE_VALUE ? "#t" : "#f");
             break;
         case CLOSURE_TYPE:
             printf("#<procedure>");
@@ -177,32 +235,51 @@ void printToken(Value *token) {
 }
 
 // Prints the tree to the screen in a readable fashion. It should look just like
-// Racket code; use parentheses to indicate subtrees.
+// Racket code; use parentheses to indicate subtrees. Lists nested in lists are
+// printed without recursing, keeping the rest of each enclosing list on a
+// stack, so printing a deep tree can't overflow the C stack.
 void printTree(Value *tree) {
-    //assert(tree->type == CONS_TYPE);
-    if(tree->type != CONS_TYPE) {
+    if(typeOf(tree) != CONS_TYPE) {
         printToken(tree);
         return;
     }
+    int depth = 0;
+    int capacity = 32;
+    Value *onStack[32];
+    Value **enclosing = onStack;
     printf("(");
     Value *current = tree;
-    while(current->type == CONS_TYPE) {
-        valueType carType = car(current)->type;
-        if (carType == CONS_TYPE) {
-            printTree(car(current));
+    while (true) {
+        if (typeOf(current) == CONS_TYPE) {
+            Value *item = car(current);
+            current = cdr(current);
+            if (typeOf(item) == CONS_TYPE) {
+                if (depth == capacity) {
+                    capacity *= 2;
+                    Value **grown = talloc(sizeof(Value *) * capacity);
+                    memcpy(grown, enclosing, sizeof(Value *) * depth);
+                    enclosing = grown;
+                }
+                enclosing[depth++] = current;
+                printf("(");
+                current = item;
+                continue;
+            }
+            printToken(item);
         }
         else {
-            printToken(car(current));
+            if (typeOf(current) != NULL_TYPE) {
+                printf(". ");
+                printToken(current);
+            }
+            printf(")");
+            if (depth == 0) {
+                return;
+            }
+            current = enclosing[--depth];
         }
-        current = cdr(current);
-        if (current->type != NULL_TYPE && current->type != SINGLE_QUOTE_TYPE) {
+        if (typeOf(current) != NULL_TYPE && typeOf(current) != SINGLE_QUOTE_TYPE) {
             printf(" ");
         }
     }
-    if (current->type != NULL_TYPE) {
-        printf(". ");
-        printToken(current);
-    }
-    printf(")");
 }
-
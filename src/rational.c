@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "value.h"
+#include "bignum.h"
+#include "rational.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// Most of the work on rationals is on their numerators and denominators, as
+// integers. When all of those are fixnums, products of two of them fit in 64
+// bits, so the arithmetic is done in int64_t and reduced with smallGcd before
+// any Value is made. Otherwise it is done with the integer functions in
+// bignum.h, which work for fixnums and bignums alike.
+
+// Returns the numerator of an exact number.
+Value *numeratorOf(Value *a) {
+    return typeOf(a) == RATIONAL_TYPE ? a->rat.numerator : a;
+}
+
+// Returns the denominator of an exact number, which is positive.
+Value *denominatorOf(Value *a) {
+    return typeOf(a) == RATIONAL_TYPE ? a->rat.denominator : makeInt(1);
+}
+
+// Returns numerator / denominator for integers that are already in lowest
+// terms, with a positive denominator.
+Value *makeRatio(Value *numerator, Value *denominator) {
+    if (denominator == makeInt(1)) {
+        return numerator;
+    }
+    Value *value = makeValue(RATIONAL_TYPE);
+    value->rat.numerator = numerator;
+    value->rat.denominator = denominator;
+    return value;
+}
+
+// Returns numerator / denominator in lowest terms, for a positive
+// denominator.
+Value *makeSmallRational(int64_t numerator, int64_t denominator) {
+    uint64_t n = numerator < 0 ? -(uint64_t)numerator : (uint64_t)numerator;
+    uint64_t gcd = smallGcd(n, denominator);
+    n /= gcd;
+    Value *reduced = makeInteger(numerator < 0 ? (int64_t)-n : (int64_t)n);
+    return makeRatio(reduced, makeInteger(denominator / gcd));
+}
+
+// Returns a / b for integers that b divides exactly.
+Value *divideExactly(Value *a, Value *b) {
+    Value *quotient;
+    integerDivide(a, b, &quotient, NULL);
+    return quotient;
+}
+
+// Returns the negation of an integer.
+Value *integerNegate(Value *a) {
+    return integerSubtract(makeInt(0), a);
+}
+
+// Returns numerator / denominator in lowest terms, for integers with a
+// nonzero denominator.
+Value *makeRational(Value *numerator, Value *denominator) {
+    if (typeOf(numerator) == INT_TYPE && typeOf(denominator) == INT_TYPE) {
+        int64_t n = intValue(numerator);
+        int64_t d = intValue(denominator);
+        return d < 0 ? makeSmallRational(-n, -d) : makeSmallRational(n, d);
+    }
+    if (integerSign(denominator) < 0) {
+        numerator = integerNegate(numerator);
+        denominator = integerNegate(denominator);
+    }
+    Value *gcd = integerGcd(numerator, denominator);
+    if (gcd != makeInt(1)) {
+        numerator = divideExactly(numerator, gcd);
+        denominator = divideExactly(denominator, gcd);
+    }
+    return makeRatio(numerator, denominator);
+}
+
+// Returns a + b, or a - b if subtract is set. When either denominator is 1
+// the result is already in lowest terms, since gcd(an + bn ad, ad) =
+// gcd(an, ad), so the gcd is only taken when both are ratios.
+Value *addRationals(Value *a, Value *b, bool subtract) {
+    Value *an = numeratorOf(a);
+    Value *ad = denominatorOf(a);
+    Value *bn = numeratorOf(b);
+    Value *bd = denominatorOf(b);
+    bool reduced = ad == makeInt(1) || bd == makeInt(1);
+    if (typeOf(an) == INT_TYPE && typeOf(ad) == INT_TYPE &&
+        typeOf(bn) == INT_TYPE && typeOf(bd) == INT_TYPE) {
+        int64_t left = (int64_t)intValue(an) * intValue(bd);
+        int64_t right = (int64_t)intValue(bn) * intValue(ad);
+        int64_t numerator;
+        if (!(subtract ? __builtin_sub_overflow(left, right, &numerator)
+                       : __builtin_add_overflow(left, right, &numerator))) {
+            int64_t denominator = (int64_t)intValue(ad) * intValue(bd);
+            if (reduced) {
+                return makeRatio(makeInteger(numerator), makeInteger(denominator));
+            }
+            return makeSmallRational(numerator, denominator);
+        }
+    }
+    Value *left = integerMultiply(an, bd);
+    Value *right = integerMultiply(bn, ad);
+    Value *numerator = subtract ? integerSubtract(left, right) : integerAdd(left, right);
+    Value *denominator = integerMultiply(ad, bd);
+    if (reduced) {
+        return makeRatio(numerator, denominator);
+    }
+    return makeRational(numerator, denominator);
+}
+
+// Returns a + b, for exact numbers that aren't both integers.
+Value *rationalAdd(Value *a, Value *b) {
+    return addRationals(a, b, false);
+}
+
+// Returns a - b, for exact numbers that aren't both integers.
+Value *rationalSubtract(Value *a, Value *b) {
+    return addRationals(a, b, true);
+}
+
+// Returns a * b, for exact numbers. Big factors are reduced crosswise
+// before multiplying, which keeps the products small and leaves them in
+// lowest terms.
+Value *rationalMultiply(Value *a, Value *b) {
+    Value *an = numeratorOf(a);
+    Value *ad = denominatorOf(a);
+    Value *bn = numeratorOf(b);
+    Value *bd = denominatorOf(b);
+    if (typeOf(an) == INT_TYPE && typeOf(ad) == INT_TYPE &&
+        typeOf(bn) == INT_TYPE && typeOf(bd) == INT_TYPE) {
+        return makeSmallRational((int64_t)intValue(an) * intValue(bn),
+                                 (int64_t)intValue(ad) * intValue(bd));
+    }
+    Value *first = integerGcd(an, bd);
+    Value *second = integerGcd(bn, ad);
+    Value *numerator = integerMultiply(divideExactly(an, first), divideExactly(bn, second));
+    Value *denominator = integerMultiply(divideExactly(ad, second), divideExactly(bd, first));
+    return makeRatio(numerator, denominator);
+}
+
+// Returns a / b for exact numbers, where b isn't zero.
+Value *exactDivide(Value *a, Value *b) {
+    if (typeOf(a) == INT_TYPE && typeOf(b) == INT_TYPE) {
+        return makeRational(a, b);
+    }
+    Value *numerator = denominatorOf(b);
+    Value *denominator = numeratorOf(b);
+    if (integerSign(denominator) < 0) {
+        numerator = integerNegate(numerator);
+        denominator = integerNegate(denominator);
+    }
+    return rationalMultiply(a, makeRatio(numerator, denominator));
+}
+
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b, by comparing an bd with bn ad.
+int rationalCompare(Value *a, Value *b) {
+    Value *an = numeratorOf(a);
+    Value *ad = denominatorOf(a);
+    Value *bn = numeratorOf(b);
+    Value *bd = denominatorOf(b);
+    if (typeOf(an) == INT_TYPE && typeOf(ad) == INT_TYPE &&
+        typeOf(bn) == INT_TYPE && typeOf(bd) == INT_TYPE) {
+        int64_t left = (int64_t)intValue(an) * intValue(bd);
+        int64_t right = (int64_t)intValue(bn) * intValue(ad);
+        return (left > right) - (left < right);
+    }
+    return integerCompare(integerMultiply(an, bd), integerMultiply(bn, ad));
+}
+
+// Returns a - b * q, where q is a / b rounded toward zero, for exact numbers
+// where b isn't zero.
+Value *exactRemainder(Value *a, Value *b) {
+    Value *remainder;
+    if (isInteger(a) && isInteger(b)) {
+        integerDivide(a, b, NULL, &remainder);
+        return remainder;
+    }
+    Value *ratio = exactDivide(a, b);
+    Value *whole;
+    integerDivide(numeratorOf(ratio), denominatorOf(ratio), &whole, NULL);
+    return exactSubtract(a, exactMultiply(b, whole));
+}
+
+// Returns the double closest to an exact number.
+double exactToDouble(Value *a) {
+    if (typeOf(a) == RATIONAL_TYPE) {
+        return integerToDouble(a->rat.numerator) / integerToDouble(a->rat.denominator);
+    }
+    return integerToDouble(a);
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <string.h>
+#include "value.h"
+#include "str.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// Strings are immutable, and made once with their length and the FNV-1a hash
+// of their bytes, so comparing two rarely has to look at the bytes and
+// hashing one for an equal? hash table is free. The bytes are followed by a
+// NUL, so they can also be handed to C functions that want one, like fopen.
+
+// Returns a new string holding a copy of length bytes.
+Value *makeString(char *bytes, size_t length) {
+    char *copy = tallocKind(length + 1, ATOMIC_KIND);
+    memcpy(copy, bytes, length);
+    copy[length] = '\0';
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)copy[i]) * 16777619u;
+    }
+    Value *string = makeValue(STR_TYPE);
+    string->str.bytes = copy;
+    string->str.length = length;
+    string->str.hash = hash;
+    return string;
+}
+
+// Whether two strings hold the same bytes.
+bool stringsEqual(Value *a, Value *b) {
+    return a->str.length == b->str.length && a->str.hash == b->str.hash &&
+        !memcmp(a->str.bytes, b->str.bytes, a->str.length);
+}
+
+// Prints a string's bytes, between double quotes if quoted is set.
+void writeString(Value *string, bool quoted) {
+    if (quoted) {
+        putchar('"');
+    }
+    fwrite(string->str.bytes, 1, string->str.length, stdout);
+    if (quoted) {
+        putchar('"');
+    }
+}
@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <string.h>
+#include "symbol.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// The symbol table is an open-addressed hash table of every symbol interned so
+// far, probed linearly. It lives in talloc'd memory and is registered as a
+// root, so the symbols in it are never collected.
+typedef struct SymbolTable {
+    int count;
+    int capacity;
+    Value *slots[];
+} SymbolTable;
+
+SymbolTable *symbols = NULL;
+
+// FNV-1a hash of the length characters of a name.
+unsigned int hashName(char *name, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Returns the slot where the symbol named by the length characters at name
+// is, or where it would go.
+Value **findSlot(SymbolTable *table, char *name, size_t length) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = hashName(name, length) & mask;
+    while (table->slots[i] != NULL &&
+           (strncmp(table->slots[i]->s, name, length) || table->slots[i]->s[length] != '\0')) {
+        i = (i + 1) & mask;
+    }
+    return &table->slots[i];
+}
+
+// Allocates an empty table with room for capacity symbols.
+SymbolTable *newTable(int capacity) {
+    SymbolTable *table = talloc(sizeof(SymbolTable) + capacity * sizeof(Value *));
+    table->count = 0;
+    table->capacity = capacity;
+    return table;
+}
+
+// Doubles the size of the table, keeping it at most half full.
+void growTable() {
+    SymbolTable *old = symbols;
+    symbols = newTable(old->capacity * 2);
+    for (int i = 0; i < old->capacity; i++) {
+        if (old->slots[i] != NULL) {
+            char *name = old->slots[i]->s;
+            *findSlot(symbols, name, strlen(name)) = old->slots[i];
+            symbols->count++;
+        }
+    }
+}
+
+// Returns the slot for the symbol named by the length characters at name,
+// which is empty if there is no such symbol yet.
+Value **lookUpName(char *name, size_t length) {
+    if (symbols == NULL) {
+        symbols = newTable(256);
+        taddroot((void **)&symbols);
+    }
+    return findSlot(symbols, name, length);
+}
+
+// Adds a new symbol to the table, with name as its string.
+Value *addSymbol(char *name, size_t length) {
+    Value *symbol = makeValue(SYMBOL_TYPE);
+    symbol->s = name;
+    symbol->sym.special = NULL;
+    *findSlot(symbols, name, length) = symbol;
+    symbols->count++;
+    if (symbols->count * 2 > symbols->capacity) {
+        growTable();
+    }
+    return symbol;
+}
+
+// Returns the SYMBOL_TYPE Value for name, creating it the first time name is
+// seen.
+Value *intern(char *name) {
+    size_t length = strlen(name);
+    Value **slot = lookUpName(name, length);
+    return *slot != NULL ? *slot : addSymbol(name, length);
+}
+
+// Returns the SYMBOL_TYPE Value named by the length characters at name. The
+// name is only copied the first time it is seen.
+Value *internSlice(char *name, size_t length) {
+    Value **slot = lookUpName(name, length);
+    if (*slot != NULL) {
+        return *slot;
+    }
+    char *copy = tallocKind(length + 1, ATOMIC_KIND);
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    return addSymbol(copy, length);
+}
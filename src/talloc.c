@@ -1,83 +1,904 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include "linkedlist.h"
-#include "value.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
 #include "talloc.h"
-#include "assert.h"
+#include "interpreter.h"
 
-Value *activeList;
+#if defined(__has_include)
+#if __has_include(<valgrind/memcheck.h>)
+#include <valgrind/memcheck.h>
+#endif
+#endif
+#ifndef VALGRIND_MAKE_MEM_DEFINED
+#define VALGRIND_MAKE_MEM_DEFINED(address, length)
+#endif
 
-// Create a new NULL_TYPE value node.
-Value *makeNullm() {
-    Value *val = malloc(sizeof(Value));
-    val->type = NULL_TYPE;
-    //val->marked = false;
-    return val;
+// The collector reads every word of the C stack and of conservative blocks,
+// including padding and dead slots no C code would touch. That is deliberate,
+// so the functions that do it are kept out of AddressSanitizer's way.
+#if defined(__GNUC__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define NO_SANITIZE_ADDRESS
+#endif
+
+// The talloc heap. Allocations are carved out of large chunks by bumping a
+// pointer, so a talloc costs a couple of additions instead of several mallocs.
+// Every block starts with a one-granule header holding its size, its kind and
+// the collector's flags, and each chunk keeps a bitmap of where blocks start so
+// that any address can be traced back to the block it points into.
+//
+// The heap is generational. New objects are bump-allocated in a small nursery
+// of young chunks. When the nursery fills up, a minor collection copies the
+// young objects that are still reachable into the old space and the nursery
+// is reused, so its cost depends on how much survives rather than on how much
+// was allocated. Roots for a minor collection are the C stack (which holds the
+// global frame, the eval stack and every live temporary), registered globals,
+// the roots that registered tracers report, and the remembered set: old
+// objects that may point at young ones. The C stack is scanned conservatively,
+// so young objects it appears to point at can't be moved. They are pinned and
+// tenured where they are, and the nursery bumps around them until a major
+// collection frees them. A nursery chunk that fills up with tenured objects is
+// handed over to the old space.
+//
+// Once enough has been promoted, a major collection marks everything reachable
+// and sweeps runs of dead blocks into holes that are bumped through again.
+// Old chunks that end up completely empty are given back to malloc.
+#define GRANULE 8
+#define CHUNK_GRANULES (8 * 1024)
+#define NURSERY_CHUNKS 128
+#define NURSERY_HOLE_GRANULES 32
+#define DEFAULT_THRESHOLD (8 * 1024 * 1024)
+
+#define MARKED 1
+#define FREE 2
+#define PINNED 4
+#define FORWARDED 8
+#define REMEMBERED 16
+#define TENURED 32
+#define KIND_SHIFT 8
+
+typedef struct Header {
+    uint32_t granules;
+    uint32_t flags;
+} Header;
+
+typedef struct Chunk {
+    struct Chunk *next;
+    size_t granules;
+    size_t used;
+    bool large;
+    bool young;
+    bool tenured;
+    uint64_t *starts;
+    uint64_t *data;
+} Chunk;
+
+// A stretch of a chunk that talloc is bumping through.
+typedef struct Region {
+    Chunk *chunk;
+    size_t cursor;
+    size_t limit;
+} Region;
+
+typedef struct Hole {
+    Chunk *chunk;
+    size_t start;
+    size_t end;
+} Hole;
+
+// Holes left by a sweep, in the order they will be handed out.
+typedef struct HoleList {
+    Hole *items;
+    int count;
+    int capacity;
+    int next;
+} HoleList;
+
+typedef struct HeaderList {
+    Header **items;
+    int count;
+    int capacity;
+} HeaderList;
+
+// Old chunks, and the nursery chunks young objects are allocated in.
+Chunk *chunkList = NULL;
+Chunk *nursery[NURSERY_CHUNKS];
+
+// All chunks sorted by address, for finding the block a pointer lands in.
+Chunk **chunkIndex = NULL;
+int chunkCount = 0;
+int chunkCapacity = 0;
+
+Region nurseryRegion = {NULL, 0, 0};
+Region oldRegion = {NULL, 0, 0};
+HoleList nurseryHoles = {NULL, 0, 0, 0};
+HoleList oldHoles = {NULL, 0, 0, 0};
+
+// Collector state. Collection only happens inside tmain, where the bottom of
+// the C stack is known.
+bool gcEnabled = false;
+char *stackBottom = NULL;
+size_t threshold = DEFAULT_THRESHOLD;
+size_t promotedSinceGC = 0;
+size_t nextGC = DEFAULT_THRESHOLD;
+
+void **roots[64];
+int rootCount = 0;
+
+void (*tracers[8])(void (*)(void **), bool);
+int tracerCount = 0;
+
+HeaderList remembered = {NULL, 0, 0};
+HeaderList conservative = {NULL, 0, 0};
+HeaderList pinned = {NULL, 0, 0};
+HeaderList work = {NULL, 0, 0};
+
+// Returns the header of the block starting at the given granule of a chunk.
+Header *blockAt(Chunk *chunk, size_t granule) {
+    return (Header *)(chunk->data + granule);
+}
+
+allocKind kindOf(Header *header) {
+    return (allocKind)(header->flags >> KIND_SHIFT);
+}
+
+void setStart(Chunk *chunk, size_t granule) {
+    chunk->starts[granule / 64] |= (uint64_t)1 << (granule % 64);
+}
+
+void clearStart(Chunk *chunk, size_t granule) {
+    chunk->starts[granule / 64] &= ~((uint64_t)1 << (granule % 64));
+}
+
+// Mallocs more memory for the collector's own bookkeeping.
+void *growArray(void *array, int *capacity, size_t itemSize) {
+    *capacity = *capacity == 0 ? 256 : *capacity * 2;
+    array = realloc(array, *capacity * itemSize);
+    if (array == NULL) {
+        printf("talloc: out of memory");
+        exit(1);
+    }
+    return array;
+}
+
+void push(HeaderList *list, Header *header) {
+    if (list->count == list->capacity) {
+        list->items = growArray(list->items, &list->capacity, sizeof(Header *));
+    }
+    list->items[list->count++] = header;
+}
+
+void freeList(HeaderList *list) {
+    free(list->items);
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// Adds a chunk to the address-sorted index.
+void indexChunk(Chunk *chunk) {
+    if (chunkCount == chunkCapacity) {
+        chunkIndex = growArray(chunkIndex, &chunkCapacity, sizeof(Chunk *));
+    }
+    int i = chunkCount;
+    while (i > 0 && chunkIndex[i - 1]->data > chunk->data) {
+        chunkIndex[i] = chunkIndex[i - 1];
+        i--;
+    }
+    chunkIndex[i] = chunk;
+    chunkCount++;
+}
+
+// Mallocs a new chunk with room for at least the given number of granules.
+Chunk *newChunk(size_t granules, bool large, bool young) {
+    size_t bitmapWords = (granules + 63) / 64;
+    Chunk *chunk = calloc(1, sizeof(Chunk) + (bitmapWords + granules) * GRANULE);
+    if (chunk == NULL) {
+        printf("talloc: out of memory");
+        texit(1);
+    }
+    chunk->granules = granules;
+    chunk->large = large;
+    chunk->young = young;
+    chunk->starts = (uint64_t *)(chunk + 1);
+    chunk->data = chunk->starts + bitmapWords;
+    indexChunk(chunk);
+    return chunk;
+}
+
+// Removes a chunk from the index and frees it.
+void releaseChunk(Chunk *chunk) {
+    int i = 0;
+    while (chunkIndex[i] != chunk) {
+        i++;
+    }
+    memmove(chunkIndex + i, chunkIndex + i + 1, (chunkCount - i - 1) * sizeof(Chunk *));
+    chunkCount--;
+    free(chunk);
+}
+
+// Returns the chunk whose allocated space contains address, or NULL.
+Chunk *findChunk(char *address) {
+    if (chunkCount == 0 || address < (char *)chunkIndex[0]->data) {
+        return NULL;
+    }
+    Chunk *last = chunkIndex[chunkCount - 1];
+    if (address >= (char *)(last->data + last->used)) {
+        return NULL;
+    }
+    int low = 0;
+    int high = chunkCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        Chunk *chunk = chunkIndex[mid];
+        char *start = (char *)chunk->data;
+        if (address < start) {
+            high = mid - 1;
+        }
+        else if (address >= start + chunk->used * GRANULE) {
+            low = mid + 1;
+        }
+        else {
+            return chunk;
+        }
+    }
+    return NULL;
+}
+
+// Returns the header of the block in chunk that address points into.
+Header *blockIn(Chunk *chunk, char *address) {
+    if (chunk->large) {
+        return blockAt(chunk, 0);
+    }
+    size_t granule = (address - (char *)chunk->data) / GRANULE;
+    size_t word = granule / 64;
+    uint64_t bits = chunk->starts[word] & (~(uint64_t)0 >> (63 - granule % 64));
+    while (bits == 0) {
+        bits = chunk->starts[--word];
+    }
+    return blockAt(chunk, word * 64 + 63 - __builtin_clzll(bits));
+}
+
+// Calls visit on every word-aligned value in [start, end). Under valgrind each
+// word is marked defined once it is copied out, since uninitialized words are
+// expected here and only ever compared against the heap's bounds.
+NO_SANITIZE_ADDRESS void scanRange(char *start, char *end, void (*visit)(void *)) {
+    void **word = (void **)(((uintptr_t)start + sizeof(void *) - 1) & ~(uintptr_t)(sizeof(void *) - 1));
+    while ((char *)(word + 1) <= end) {
+        void *value = *word;
+        VALGRIND_MAKE_MEM_DEFINED(&value, sizeof(value));
+        visit(value);
+        word++;
+    }
+}
+
+// Calls visit on every word of the C stack below the collector. Callers spill
+// callee-saved registers into their frames first, so this sees them too.
+NO_SANITIZE_ADDRESS void scanStack(void (*visit)(void *)) {
+    char top;
+    scanRange(&top, stackBottom, visit);
+}
+
+// Calls visit on a field holding a Value, unless it is an immediate or NULL.
+void visitValue(Value **field, void (*visit)(void **)) {
+    if (!isImmediate(*field) && *field != NULL) {
+        visit((void **)field);
+    }
+}
+
+// Calls visit on the address of every pointer field of an object whose layout
+// the collector knows. Conservative and atomic objects have none.
+void traceObject(Header *header, void (*visit)(void **)) {
+    switch (kindOf(header)) {
+        case VALUE_KIND: {
+            Value *value = (Value *)(header + 1);
+            switch (value->type) {
+                case CONS_TYPE:
+                    visitValue(&value->c.car, visit);
+                    visitValue(&value->c.cdr, visit);
+                    break;
+                case CLOSURE_TYPE:
+                    visit((void **)&value->cl.code);
+                    visit((void **)&value->cl.frame);
+                    break;
+                case STR_TYPE:
+                case SYMBOL_TYPE:
+                case OPEN_TYPE:
+                case CLOSE_TYPE:
+                case OPEN_BRACKET_TYPE:
+                case OPEN_VECTOR_TYPE:
+                case CLOSE_BRACKET_TYPE:
+                case DOT_TYPE:
+                case SINGLE_QUOTE_TYPE:
+                    visit((void **)&value->s);
+                    break;
+                case PTR_TYPE:
+                    visit(&value->p);
+                    break;
+                case PRIMITIVE_TYPE:
+                    visit((void **)&value->prim);
+                    break;
+                case BIGNUM_TYPE:
+                    visit((void **)&value->big.digits);
+                    break;
+                case VECTOR_TYPE:
+                    visit((void **)&value->vec.items);
+                    break;
+                case HASH_TABLE_TYPE:
+                    visit((void **)&value->ht.slots);
+                    break;
+                case F64VECTOR_TYPE:
+                case S64VECTOR_TYPE:
+                    visit(&value->nv.elements);
+                    break;
+                case RATIONAL_TYPE:
+                    visitValue(&value->rat.numerator, visit);
+                    visitValue(&value->rat.denominator, visit);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+        case FRAME_KIND: {
+            Frame *frame = (Frame *)(header + 1);
+            visit((void **)&frame->parent);
+            for (int i = 0; i < frame->count; i++) {
+                visitValue(&frame->slots[i], visit);
+            }
+            break;
+        }
+        case ARRAY_KIND: {
+            Value **items = (Value **)(header + 1);
+            for (uint32_t i = 0; i < header->granules - 1; i++) {
+                visitValue(&items[i], visit);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Whether a block is in the nursery and may still be moved. Objects pinned by
+// an earlier minor collection stay in their nursery chunk but count as old.
+bool isYoung(Chunk *chunk, Header *header) {
+    return chunk->young && !(header->flags & TENURED);
+}
+
+// Records an old object that may now point at young ones.
+void remember(Header *header) {
+    if (!(header->flags & REMEMBERED)) {
+        header->flags |= REMEMBERED;
+        push(&remembered, header);
+    }
+}
+
+// Bumps a block of the given size out of a region that is known to have room.
+Header *bump(Region *region, size_t granules) {
+    Chunk *chunk = region->chunk;
+    setStart(chunk, region->cursor);
+    Header *header = blockAt(chunk, region->cursor);
+    region->cursor += granules;
+    if (region->cursor > chunk->used) {
+        chunk->used = region->cursor;
+    }
+    header->granules = granules;
+    return header;
+}
+
+// Gives up on the rest of a region. If it is a stretch in the middle of a
+// chunk, what's left becomes a free block so the chunk can still be walked
+// block by block.
+void retireRegion(Region *region) {
+    if (region->chunk != NULL && region->cursor < region->limit && region->limit <= region->chunk->used) {
+        setStart(region->chunk, region->cursor);
+        Header *header = blockAt(region->chunk, region->cursor);
+        header->granules = region->limit - region->cursor;
+        header->flags = FREE;
+    }
+    region->chunk = NULL;
+    region->cursor = 0;
+    region->limit = 0;
+}
+
+// Records a stretch of free granules to be bumped through.
+void addHole(HoleList *list, Chunk *chunk, size_t start, size_t end) {
+    if (end - start < 2) {
+        return;
+    }
+    if (list->count == list->capacity) {
+        list->items = growArray(list->items, &list->capacity, sizeof(Hole));
+    }
+    list->items[list->count].chunk = chunk;
+    list->items[list->count].start = start;
+    list->items[list->count].end = end;
+    list->count++;
+}
+
+// Points a region at the next hole in the list with room for the given number
+// of granules. Returns false if there is none.
+bool nextHole(HoleList *list, Region *region, size_t granules) {
+    retireRegion(region);
+    while (list->next < list->count) {
+        Hole *hole = &list->items[list->next++];
+        if (hole->end - hole->start >= granules) {
+            region->chunk = hole->chunk;
+            region->cursor = hole->start;
+            region->limit = hole->end;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Turns a run of dead granules into a single zeroed free block.
+void freeRun(Chunk *chunk, size_t start, size_t granules) {
+    memset(chunk->data + start, 0, granules * GRANULE);
+    Header *header = blockAt(chunk, start);
+    header->granules = granules;
+    header->flags = FREE;
+}
+
+// Walks every block in a chunk, keeping the ones with any of the keep flags
+// set and merging runs of the rest into holes. Kept blocks lose their mark;
+// pinned ones become tenured, and are remembered until the next minor
+// collection since the C code holding them may still be filling them in.
+// Returns the number of live granules.
+size_t sweepChunk(Chunk *chunk, uint32_t keep, HoleList *holes) {
+    size_t live = 0;
+    size_t granule = 0;
+    size_t runStart = 0;
+    size_t runLength = 0;
+    while (granule < chunk->used) {
+        Header *header = blockAt(chunk, granule);
+        size_t granules = header->granules;
+        if (header->flags & keep) {
+            if (header->flags & PINNED) {
+                header->flags = (header->flags & ~PINNED) | TENURED;
+                remember(header);
+            }
+            header->flags &= ~MARKED;
+            live += granules;
+            if (runLength > 0) {
+                freeRun(chunk, runStart, runLength);
+                addHole(holes, chunk, runStart, granule);
+                runLength = 0;
+            }
+        }
+        else if (runLength == 0) {
+            runStart = granule;
+            runLength = granules;
+        }
+        else {
+            clearStart(chunk, granule);
+            runLength += granules;
+        }
+        granule += granules;
+    }
+    if (runLength > 0) {
+        // Dead space at the end of a chunk goes back to its unused tail.
+        clearStart(chunk, runStart);
+        memset(chunk->data + runStart, 0, runLength * GRANULE);
+        chunk->used = runStart;
+    }
+    if (!chunk->large) {
+        addHole(holes, chunk, chunk->used, chunk->granules);
+    }
+    return live;
+}
+
+// Allocates a block in the old space: out of the next hole with room for it,
+// or out of a fresh chunk if there is none. Allocations too big to share a
+// chunk get one of their own.
+Header *allocOld(size_t granules) {
+    promotedSinceGC += granules * GRANULE;
+    if (granules > CHUNK_GRANULES / 4) {
+        Chunk *chunk = newChunk(granules, true, false);
+        chunk->next = chunkList;
+        chunkList = chunk;
+        chunk->used = granules;
+        setStart(chunk, 0);
+        Header *header = blockAt(chunk, 0);
+        header->granules = granules;
+        return header;
+    }
+    if (oldRegion.limit - oldRegion.cursor < granules && !nextHole(&oldHoles, &oldRegion, granules)) {
+        Chunk *chunk = newChunk(CHUNK_GRANULES, false, false);
+        chunk->next = chunkList;
+        chunkList = chunk;
+        oldRegion.chunk = chunk;
+        oldRegion.limit = CHUNK_GRANULES;
+    }
+    return bump(&oldRegion, granules);
+}
+
+// Pins a young object the C stack seems to point at, and remembers an old
+// one, since C code may store young pointers into it without a barrier.
+void pinFromStack(void *word) {
+    Chunk *chunk = findChunk(word);
+    if (chunk == NULL) {
+        return;
+    }
+    Header *header = blockIn(chunk, word);
+    if (header->flags & FREE) {
+        return;
+    }
+    if (!isYoung(chunk, header)) {
+        remember(header);
+    }
+    else if (!(header->flags & PINNED)) {
+        header->flags |= PINNED;
+        chunk->tenured = true;
+        push(&pinned, header);
+    }
+}
+
+// Pins a young object that a conservatively scanned object seems to point at.
+void pinFromHeap(void *word) {
+    Chunk *chunk = findChunk(word);
+    if (chunk == NULL || !chunk->young) {
+        return;
+    }
+    Header *header = blockIn(chunk, word);
+    if (!(header->flags & (FREE | PINNED | TENURED))) {
+        header->flags |= PINNED;
+        chunk->tenured = true;
+        push(&pinned, header);
+    }
+}
+
+// Updates a pointer field to a young object that isn't pinned, copying the
+// object into the old space the first time it is seen.
+void forwardField(void **field) {
+    char *address = *field;
+    Chunk *chunk = findChunk(address);
+    if (chunk == NULL || !chunk->young) {
+        return;
+    }
+    Header *header = blockIn(chunk, address);
+    if (header->flags & (FREE | PINNED | TENURED)) {
+        return;
+    }
+    if (!(header->flags & FORWARDED)) {
+        Header *copy = allocOld(header->granules);
+        memcpy(copy + 1, header + 1, (header->granules - 1) * GRANULE);
+        copy->flags = header->flags;
+        header->flags |= FORWARDED;
+        *(Header **)(header + 1) = copy;
+        push(&work, copy);
+    }
+    Header *copy = *(Header **)(header + 1);
+    *field = (char *)(copy + 1) + (address - (char *)(header + 1));
+}
+
+// Forwards a root reported by a tracer, which may hold an immediate Value.
+void forwardRoot(void **field) {
+    visitValue((Value **)field, forwardField);
+}
+
+// Sweeps the nursery chunks into fresh nursery holes and returns how many
+// granules they hold. Slivers between tenured objects would cost a trip
+// through refillNursery for every allocation or two, so only sizeable holes
+// are kept. Tenured objects that are still alive after a major collection are
+// likely to stay, so a chunk they leave little room in is then handed over to
+// the old space, holes and all, and replaced with an empty one.
+size_t sweepNursery(uint32_t keep, bool major) {
+    size_t free = 0;
+    nurseryHoles.count = 0;
+    nurseryHoles.next = 0;
+    for (int i = 0; i < NURSERY_CHUNKS; i++) {
+        Chunk *chunk = nursery[i];
+        if (!chunk->tenured) {
+            // Nothing in this chunk outlives the collection.
+            memset(chunk->data, 0, chunk->used * GRANULE);
+            memset(chunk->starts, 0, (CHUNK_GRANULES / 64) * sizeof(uint64_t));
+            chunk->used = 0;
+            addHole(&nurseryHoles, chunk, 0, CHUNK_GRANULES);
+            free += CHUNK_GRANULES;
+            continue;
+        }
+        int first = nurseryHoles.count;
+        chunk->tenured = sweepChunk(chunk, keep, &nurseryHoles) > 0;
+        size_t room = 0;
+        for (int j = first; j < nurseryHoles.count; j++) {
+            Hole *hole = &nurseryHoles.items[j];
+            if (hole->end - hole->start >= NURSERY_HOLE_GRANULES) {
+                room += hole->end - hole->start;
+            }
+        }
+        if (major && room < CHUNK_GRANULES / 2) {
+            for (int j = first; j < nurseryHoles.count; j++) {
+                Hole *hole = &nurseryHoles.items[j];
+                addHole(&oldHoles, chunk, hole->start, hole->end);
+            }
+            nurseryHoles.count = first;
+            chunk->young = false;
+            chunk->next = chunkList;
+            chunkList = chunk;
+            nursery[i] = newChunk(CHUNK_GRANULES, false, true);
+            addHole(&nurseryHoles, nursery[i], 0, CHUNK_GRANULES);
+            free += CHUNK_GRANULES;
+            continue;
+        }
+        int kept = first;
+        for (int j = first; j < nurseryHoles.count; j++) {
+            Hole *hole = &nurseryHoles.items[j];
+            if (hole->end - hole->start >= NURSERY_HOLE_GRANULES) {
+                nurseryHoles.items[kept++] = *hole;
+            }
+        }
+        nurseryHoles.count = kept;
+        free += room;
+    }
+    return free;
+}
+
+// Copies everything reachable in the nursery that isn't pinned into the old
+// space and frees the rest of it. Old objects the stack points at are
+// remembered until the next minor collection, since the C code holding them
+// may still be filling them in.
+size_t minorCollect() {
+    retireRegion(&nurseryRegion);
+    HeaderList previous = remembered;
+    remembered = (HeaderList){NULL, 0, 0};
+    for (int i = 0; i < previous.count; i++) {
+        previous.items[i]->flags &= ~REMEMBERED;
+    }
+
+    // Decide what can't move before anything does.
+    scanStack(pinFromStack);
+    for (int i = 0; i < conservative.count; i++) {
+        Header *header = conservative.items[i];
+        scanRange((char *)(header + 1), (char *)(header + header->granules), pinFromHeap);
+    }
+
+    for (int i = 0; i < previous.count; i++) {
+        traceObject(previous.items[i], forwardField);
+    }
+    for (int i = 0; i < remembered.count; i++) {
+        traceObject(remembered.items[i], forwardField);
+    }
+    for (int i = 0; i < pinned.count; i++) {
+        promotedSinceGC += pinned.items[i]->granules * GRANULE;
+        traceObject(pinned.items[i], forwardField);
+    }
+    for (int i = 0; i < rootCount; i++) {
+        forwardField(roots[i]);
+    }
+    for (int i = 0; i < tracerCount; i++) {
+        tracers[i](forwardRoot, true);
+    }
+    while (work.count > 0) {
+        traceObject(work.items[--work.count], forwardField);
+    }
+    freeList(&previous);
+    pinned.count = 0;
+    return sweepNursery(PINNED | TENURED, false);
+}
+
+// Marks the object a word points into, if any, and queues it to be scanned.
+void markWord(void *word) {
+    Chunk *chunk = findChunk(word);
+    if (chunk == NULL) {
+        return;
+    }
+    Header *header = blockIn(chunk, word);
+    if (!(header->flags & (MARKED | FREE))) {
+        header->flags |= MARKED;
+        push(&work, header);
+    }
+}
+
+void markField(void **field) {
+    markWord(*field);
+}
+
+// Marks a root reported by a tracer, which may hold an immediate Value.
+void markRoot(void **field) {
+    visitValue((Value **)field, markField);
+}
+
+// Drops the objects that weren't marked from a list.
+void keepMarked(HeaderList *list) {
+    int kept = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i]->flags & MARKED) {
+            list->items[kept++] = list->items[i];
+        }
+    }
+    list->count = kept;
+}
+
+// Sweeps every old chunk, freeing the ones with nothing live left in them.
+// Returns the number of live granules.
+size_t sweep() {
+    size_t live = 0;
+    oldHoles.count = 0;
+    oldHoles.next = 0;
+    Chunk **link = &chunkList;
+    while (*link != NULL) {
+        Chunk *chunk = *link;
+        int first = oldHoles.count;
+        size_t granules = sweepChunk(chunk, MARKED, &oldHoles);
+        if (granules == 0) {
+            oldHoles.count = first;
+            *link = chunk->next;
+            releaseChunk(chunk);
+            continue;
+        }
+        live += granules;
+        link = &chunk->next;
+    }
+    return live;
+}
+
+// Marks everything reachable and sweeps the rest, including tenured objects
+// in the nursery. Runs just after a minor collection, so nothing in the
+// nursery is young.
+void majorCollect() {
+    retireRegion(&oldRegion);
+    scanStack(markWord);
+    for (int i = 0; i < rootCount; i++) {
+        markWord(*roots[i]);
+    }
+    for (int i = 0; i < tracerCount; i++) {
+        tracers[i](markRoot, false);
+    }
+    while (work.count > 0) {
+        Header *header = work.items[--work.count];
+        if (kindOf(header) == CONSERVATIVE_KIND) {
+            scanRange((char *)(header + 1), (char *)(header + header->granules), markWord);
+        }
+        else {
+            traceObject(header, markField);
+        }
+    }
+    keepMarked(&remembered);
+    keepMarked(&conservative);
+    size_t live = sweep() * GRANULE;
+    sweepNursery(MARKED, true);
+    promotedSinceGC = 0;
+    nextGC = live > threshold ? live : threshold;
+}
+
+// Runs a minor collection, and a major one too if major is set, if enough has
+// been promoted since the last, or if tenured objects are crowding the
+// nursery. Callee-saved registers are spilled into this frame first so that
+// pointers held only in registers are seen on the stack.
+void collect(bool major) {
+    jmp_buf registers;
+#if defined(__GNUC__)
+    __builtin_unwind_init();
+#endif
+    setjmp(registers);
+    gcEnabled = false;
+    size_t free = minorCollect();
+    if (major || promotedSinceGC >= nextGC || free < NURSERY_CHUNKS * CHUNK_GRANULES / 4) {
+        majorCollect();
+    }
+    gcEnabled = true;
+}
+
+// Moves on to the next nursery hole with room for the given number of
+// granules. When there are none left the nursery is collected, or, outside
+// tmain, its chunks simply become part of the old space. Returns false if
+// even a collection leaves no room.
+bool refillNursery(size_t granules) {
+    if (nursery[0] == NULL) {
+        for (int i = 0; i < NURSERY_CHUNKS; i++) {
+            nursery[i] = newChunk(CHUNK_GRANULES, false, true);
+            addHole(&nurseryHoles, nursery[i], 0, CHUNK_GRANULES);
+        }
+    }
+    if (nextHole(&nurseryHoles, &nurseryRegion, granules)) {
+        return true;
+    }
+    if (gcEnabled) {
+        collect(false);
+    }
+    else {
+        nurseryHoles.count = 0;
+        nurseryHoles.next = 0;
+        for (int i = 0; i < NURSERY_CHUNKS; i++) {
+            nursery[i]->young = false;
+            nursery[i]->next = chunkList;
+            chunkList = nursery[i];
+            nursery[i] = newChunk(CHUNK_GRANULES, false, true);
+            addHole(&nurseryHoles, nursery[i], 0, CHUNK_GRANULES);
+        }
+    }
+    return nextHole(&nurseryHoles, &nurseryRegion, granules);
 }
 
-// Create a new CONS_TYPE value node.
-Value *consm(Value *newCar, Value *newCdr) {
-    Value *node = malloc(sizeof(Value));
-    node->type = CONS_TYPE;
-    //node->marked = false;
-    node->c.car = newCar;
-    node->c.cdr = newCdr;
-    return node;
+// Allocates memory of the given kind. Young objects are bump-allocated in the
+// nursery. Conservative objects and ones too big to share a chunk go straight
+// to the old space, and are remembered or scanned at every minor collection
+// since whoever allocated them may fill them with young pointers.
+void *tallocKind(size_t size, allocKind kind) {
+    size_t granules = 1 + (size + GRANULE - 1) / GRANULE;
+    if (granules < 2) {
+        granules = 2;
+    }
+    Header *header;
+    bool old = kind == CONSERVATIVE_KIND || granules > CHUNK_GRANULES / 4;
+    if (!old && nurseryRegion.limit - nurseryRegion.cursor < granules) {
+        old = !refillNursery(granules);
+    }
+    if (old) {
+        if (gcEnabled && promotedSinceGC >= nextGC) {
+            collect(true);
+        }
+        header = allocOld(granules);
+        header->flags = kind << KIND_SHIFT;
+        if (kind == CONSERVATIVE_KIND) {
+            push(&conservative, header);
+        }
+        else {
+            remember(header);
+        }
+        return header + 1;
+    }
+    header = bump(&nurseryRegion, granules);
+    header->flags = kind << KIND_SHIFT;
+    return header + 1;
 }
 
-// Replacement for malloc that stores the pointers allocated. It should store
-// the pointers in some kind of list; a linked list would do fine, but insert
-// here whatever code you'll need to do so; don't call functions in the
-// pre-existing linkedlist.h. Otherwise you'll end up with circular
-// dependencies, since you're going to modify the linked list to use talloc.
+// Replacement for malloc. The collector doesn't know what is stored in this
+// memory, so it is scanned conservatively and never moved.
 void *talloc(size_t size) {
-    if (activeList == NULL) {
-        activeList = makeNullm();
+    return tallocKind(size, CONSERVATIVE_KIND);
+}
+
+// Write barrier: call after storing a pointer into an object that may have
+// been allocated a while ago.
+void tbarrier(void *object) {
+    Chunk *chunk = findChunk(object);
+    if (chunk != NULL) {
+        Header *header = blockIn(chunk, object);
+        if (!isYoung(chunk, header)) {
+            remember(header);
+        }
     }
-    void *new = malloc(size);
-    //new->marked = false;
-    Value *p = malloc(sizeof(Value));
-    p->type = PTR_TYPE;
-    p->p = new;
-    //p->marked = false;
-    activeList = consm(p, activeList);
-    return new;
 }
 
-// Free all pointers allocated by talloc, as well as whatever memory you
-// allocated in lists to hold those pointers.
+// Free all memory allocated by talloc, one chunk at a time. Registered roots
+// are cleared and forgotten.
 void tfree() {
-    if (activeList == NULL) return;
-    Value *new = NULL;
-    Value *current = activeList;
-    Value *next;
-    while(current->type != NULL_TYPE) {
-        next = cdr(current);
-        Value* val = ((Value*)(car(current)->p));
-        free(car(current)->p);
-        free(car(current));
-        free(current);
-//        if (!val->marked){
-//            free(car(current)->p);
-//            free(car(current));
-//            free(current);
-//        }
-//        else {
-//            ((Value*)(car(current)->p))->marked = false;
-//            if (new == NULL) new = makeNullm();
-//            new = consm(car(current), new);
-//            free(current);
-//        }
-        current = next;
-    }
-    free(current);
-//    if (!current->marked) {
-//        free(current);
-//    } else {
-//        new = cons(current, new);
-//    }
-    activeList = new;
+    for (int i = 0; i < rootCount; i++) {
+        *roots[i] = NULL;
+    }
+    rootCount = 0;
+    tracerCount = 0;
+    while (chunkList != NULL) {
+        Chunk *next = chunkList->next;
+        free(chunkList);
+        chunkList = next;
+    }
+    for (int i = 0; i < NURSERY_CHUNKS; i++) {
+        free(nursery[i]);
+        nursery[i] = NULL;
+    }
+    free(chunkIndex);
+    chunkIndex = NULL;
+    chunkCount = 0;
+    chunkCapacity = 0;
+    free(oldHoles.items);
+    oldHoles = (HoleList){NULL, 0, 0, 0};
+    free(nurseryHoles.items);
+    nurseryHoles = (HoleList){NULL, 0, 0, 0};
+    nurseryRegion = (Region){NULL, 0, 0};
+    oldRegion = (Region){NULL, 0, 0};
+    freeList(&remembered);
+    freeList(&conservative);
+    freeList(&pinned);
+    freeList(&work);
+    promotedSinceGC = 0;
+    nextGC = threshold;
 }
 
 // Replacement for the C function "exit", that consists of two lines: it calls
@@ -88,12 +909,49 @@ void texit(int status) {
     exit(status);
 }
 
-// Marks items in list to not be deleted.
-//void mark(Value *value) {
-//    value->marked = true;
-//}
+// Runs program with the garbage collector enabled. This frame marks the bottom
+// of the stack the collector scans for roots.
+int tmain(int (*program)(int, char **), int argc, char **argv) {
+    char bottom;
+    stackBottom = &bottom;
+    gcEnabled = true;
+    int status = program(argc, argv);
+    gcEnabled = false;
+    return status;
+}
 
-int getActiveListLength() {
-    return length(activeList);
+// Sets how many bytes may be promoted between major collections.
+void tsetthreshold(size_t bytes) {
+    threshold = bytes;
+    nextGC = bytes;
 }
 
+// Registers a global variable holding a talloc'd pointer as a root.
+void taddroot(void **root) {
+    if (rootCount == 64) {
+        printf("talloc: too many roots");
+        texit(1);
+    }
+    roots[rootCount++] = root;
+}
+
+// Registers a function that reports roots held outside talloc'd memory.
+void taddtracer(void (*tracer)(void (*visit)(void **), bool young)) {
+    if (tracerCount == 8) {
+        printf("talloc: too many tracers");
+        texit(1);
+    }
+    tracers[tracerCount++] = tracer;
+}
+
+// Forces a full collection now.
+void tcollect() {
+    if (gcEnabled) {
+        collect(true);
+    }
+}
+
+// Returns the number of chunks currently held by talloc.
+int getChunkCount() {
+    return chunkCount;
+}
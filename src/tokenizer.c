@@ -1,255 +1,412 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "linkedlist.h"
 #include "value.h"
 #include "talloc.h"
+#include "symbol.h"
+#include "str.h"
+#include "bignum.h"
+#include "rational.h"
+#include "kernels.h"
+#include "tokenizer.h"
 #include "assert.h"
 #include <ctype.h>
 
-FILE *inputFile = NULL;
-char misc[] = {'!', '$', '%', '&', '*', '/', ':', '<', '=', '>', '?', '~', '_', '^'};
-char brackets_quote[] = {'(', '[', ']', ')', '\''};
+// A regular file is mapped into memory and scanned with a cursor; anything
+// else, like a pipe, is read into a buffer as the cursor reaches the end of
+// what has been read. A token's text is a slice of the source, found by
+// moving the cursor to its end, and is only copied if the token needs to
+// keep it. Tokens are handed out one at a time, and once a token has been
+// read the text before it is no longer needed: the buffer drops it when it
+// next fills, and the pages of a mapped file are released every
+// RELEASE_SIZE bytes, so the memory used doesn't grow with the file. The
+// ends of words and of runs of whitespace are found 32 characters at a time,
+// by the classifyChars kernel.
 
-// Cycles to the next character in the file, ignores comments.
-void nextChar(char *charRead, bool inString) {
-    *charRead = (char)fgetc(inputFile);
+#define BUFFER_SIZE 65536
+#define RELEASE_SIZE (1 << 22)
 
-    if (*charRead == ';' && !inString){
-        while (*charRead != (char)10) {
-            *charRead = (char)fgetc(inputFile);
-            if(*charRead == EOF) return;
-        }
-        *charRead = (char)fgetc(inputFile);
+// The text of the file being tokenized, and the cursor: the offset of the
+// next character to read. start is the offset of the token being read.
+// length is how much of the file is in text, which is all of it once ended
+// is set. If text is a buffer, rather than mapped, it holds capacity bytes,
+// and more of file is read into it as needed. released is how much of a
+// mapped file has been given back. classify is the kernel that classifies
+// characters.
+struct Source {
+    char *text;
+    size_t length;
+    size_t position;
+    size_t start;
+    bool ended;
+    bool mapped;
+    size_t released;
+    int file;
+    size_t capacity;
+    CharMasks (*classify)(char *text);
+};
+
+// The text of a token: length characters of the source, from offset. classes
+// holds the CHAR_DIGIT and CHAR_SYMBOL bits if every character in it is in
+// that class.
+typedef struct Slice {
+    size_t offset;
+    size_t length;
+    unsigned classes;
+} Slice;
+
+// Opens the named file for reading tokens from. A regular file is mapped
+// into memory whole; for anything else, like an empty file or a pipe, a
+// buffer is allocated and filled as it is read.
+Source *openSource(char *inputFileName) {
+    int file = open(inputFileName, O_RDONLY);
+    struct stat info;
+    if (file < 0 || fstat(file, &info) < 0) {
+        printf("Error: Cannot open file %s", inputFileName);
+        texit(1);
+    }
+    Source *source = malloc(sizeof(Source));
+    source->position = 0;
+    source->start = 0;
+    source->released = 0;
+    source->classify = getKernels()->classifyChars;
+    source->mapped = false;
+    if (S_ISREG(info.st_mode) && info.st_size > 0) {
+        source->text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        source->mapped = source->text != MAP_FAILED;
+    }
+    if (source->mapped) {
+        close(file);
+        source->length = info.st_size;
+        source->ended = true;
+        source->file = -1;
+    }
+    else {
+        source->capacity = BUFFER_SIZE;
+        source->text = malloc(source->capacity);
+        source->length = 0;
+        source->ended = false;
+        source->file = file;
+    }
+    return source;
+}
+
+// Closes a source, releasing its text.
+void closeSource(Source *source) {
+    if (source->mapped) {
+        munmap(source->text, source->length);
+    }
+    else {
+        close(source->file);
+        free(source->text);
     }
+    free(source);
 }
 
-// Concatenate a character onto the end of a string
-char *catLetter(char const *string, char const *c) {
-    char *new = talloc(sizeof(char[255]));
-    int i = 0;
-    if (*string == (char)0) {
-        new[0] = *c;
-        new[1] = '\0';
-        return new;
+// Reads more of a source that isn't mapped into its buffer. The token being
+// read is first moved to the front, dropping the text before it, and the
+// buffer doubles if the token fills it. Offsets into the text are all
+// reduced by the old start. Returns false at the end of the file.
+bool fillSource(Source *source) {
+    if (source->ended) {
+        return false;
     }
-    while(*(string + i) != (char)0) {
-        new[i] = string[i];
-        i ++;
+    if (source->start > 0) {
+        memmove(source->text, source->text + source->start, source->length - source->start);
+        source->length -= source->start;
+        source->position -= source->start;
+        source->start = 0;
+    }
+    if (source->length == source->capacity) {
+        source->capacity *= 2;
+        source->text = realloc(source->text, source->capacity);
+    }
+    ssize_t count = read(source->file, source->text + source->length,
+                         source->capacity - source->length);
+    if (count <= 0) {
+        source->ended = true;
+        return false;
+    }
+    source->length += count;
+    return true;
+}
+
+// Whether there is more text at the cursor, reading more if need be.
+bool hasMore(Source *source) {
+    return source->position < source->length || fillSource(source);
+}
+
+// Lets the kernel drop the pages of a mapped source before the cursor, once
+// there are RELEASE_SIZE bytes of them.
+void releaseRead(Source *source) {
+    if (source->mapped && source->position - source->released >= RELEASE_SIZE) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t end = source->position / page * page;
+        madvise(source->text + source->released, end - source->released, MADV_DONTNEED);
+        source->released = end;
+    }
+}
+
+// Returns the character at the cursor, or EOF at the end of the source.
+int peekChar(Source *source) {
+    if (!hasMore(source)) {
+        return EOF;
     }
-    new[i] = *c;
-    new[i+1] = '\0';
-    return new;
+    return (unsigned char)source->text[source->position];
 }
 
-// Makes Value of corresponding type for single characters only
-Value *makeStringValue(char const *s, valueType t) {
-    Value *newVal = makeNull();
-    newVal->type = t;
-    char *new = talloc(sizeof(char[255]));
-    new[0] = '\0';
-    new = catLetter(new, s);
-    newVal->s = new;
-    return newVal;
+// Makes a token Value of the given type, whose text is a constant string.
+Value *makeToken(valueType type, char *text) {
+    Value *token = makeValue(type);
+    token->s = text;
+    return token;
 }
 
-// Checks if char is either a parenthesis or quote
-bool isParenOrQuote(char const *s) {
-    for (int i = 0; i < 5; i++) {
-        if (*s == brackets_quote[i]) {
-            return true;
+// Checks if char ends a symbol, number or boolean: whitespace, a
+// parenthesis or quote, the start of a comment, or the end of the source.
+bool isDelimiter(int c) {
+    return c == EOF || (charClasses[c] & CHAR_DELIMITER);
+}
+
+// Classifies the 32 characters from the cursor on. Past the end of the source
+// they are classified as spaces.
+CharMasks classifyAt(Source *source) {
+    while (source->length - source->position < 32 && fillSource(source)) {
+    }
+    if (source->length - source->position >= 32) {
+        return source->classify(source->text + source->position);
+    }
+    char block[32];
+    memset(block, ' ', sizeof(block));
+    memcpy(block, source->text + source->position, source->length - source->position);
+    return source->classify(block);
+}
+
+// Moves the cursor up to the next delimiter, and returns the slice passed
+// over.
+Slice scanWord(Source *source) {
+    size_t begin = source->position - source->start;
+    Slice word = {0, 0, CHAR_DIGIT | CHAR_SYMBOL};
+    while (true) {
+        CharMasks masks = classifyAt(source);
+        int end = masks.delimiters == 0 ? 32 : __builtin_ctz(masks.delimiters);
+        uint32_t inWord = end == 32 ? 0xffffffff : ((uint32_t)1 << end) - 1;
+        if ((masks.digits & inWord) != inWord) {
+            word.classes &= ~CHAR_DIGIT;
+        }
+        if ((masks.symbols & inWord) != inWord) {
+            word.classes &= ~CHAR_SYMBOL;
+        }
+        source->position += end;
+        if (end < 32) {
+            break;
+        }
+    }
+    word.offset = source->start + begin;
+    word.length = source->position - word.offset;
+    return word;
+}
+
+// Moves the cursor past any whitespace.
+void skipWhitespace(Source *source) {
+    while (hasMore(source)) {
+        source->start = source->position;
+        uint32_t other = ~classifyAt(source).whitespace;
+        if (other != 0) {
+            source->position += __builtin_ctz(other);
+            return;
+        }
+        source->position += 32;
+        if (source->position > source->length) {
+            source->position = source->length;
         }
     }
-    return false;
 }
 
+// Moves the cursor to the end of a comment, at the newline.
+void skipComment(Source *source) {
+    while (hasMore(source)) {
+        source->start = source->position;
+        char *newline = memchr(source->text + source->position, '\n',
+                               source->length - source->position);
+        if (newline != NULL) {
+            source->position = newline - source->text;
+            return;
+        }
+        source->position = source->length;
+    }
+}
 
 // Creates corresponding bracket Value for bracket char
 Value *tokenizeBracket(char charRead) {
-    valueType type = NULL_TYPE;
     switch (charRead) {
         case '(':
-            type = OPEN_TYPE;
-            break;
+            return makeToken(OPEN_TYPE, "(");
         case '[':
-            type = OPEN_BRACKET_TYPE;
-            break;
+            return makeToken(OPEN_BRACKET_TYPE, "[");
         case ')':
-            type = CLOSE_TYPE;
-            break;
-        case ']':
-            type = CLOSE_BRACKET_TYPE;
-            break;
+            return makeToken(CLOSE_TYPE, ")");
         default:
-            break;
+            return makeToken(CLOSE_BRACKET_TYPE, "]");
     }
-    return makeStringValue(&charRead, type);
 }
 
-// Creates String type Value
-Value *tokenizeString(char *charRead) {
-    char* new = talloc(sizeof(char[255]));
-    new[0] = '\0';
-    new = catLetter(new, charRead);
-    nextChar(charRead, true);
-    while(*charRead != '"') {
-        if (*charRead == EOF) {
+// Creates String type Value from what is between the quotes, for a cursor at
+// the opening quote, which starts the token. Comments aren't skipped inside a
+// string.
+Value *tokenizeString(Source *source) {
+    size_t searched = 1;
+    while (true) {
+        char *open = source->text + source->start;
+        char *end = memchr(open + searched, '"', source->length - source->start - searched);
+        if (end != NULL) {
+            source->position = end + 1 - source->text;
+            return makeString(open + 1, end - open - 1);
+        }
+        searched = source->length - source->start;
+        if (!fillSource(source)) {
             printf("Syntax Error: Missing \"");
             texit(1);
         }
-        new = catLetter(new, charRead);
-        nextChar(charRead, true);
     }
-    new = catLetter(new, charRead);
-    Value *stringVal = makeNull();
-    stringVal->type = STR_TYPE;
-    stringVal->s = new;
-    return stringVal;
 }
 
-// Creates Int/Double type Value for a number
-Value *tokenizeNumber(char *charRead, char sign) {
+// Creates Int/Double/Rational type Value for a number, for a cursor at its
+// first digit.
+Value *tokenizeNumber(Source *source, char sign) {
+    Slice word = scanWord(source);
+    char *digits = source->text + word.offset;
+    if (word.classes & CHAR_DIGIT) {
+        return parseInteger(digits, word.length, sign == '-');
+    }
     valueType type = INT_TYPE;
-    char* new = talloc(sizeof(char[255]));
-    new[0] = '\0';
-    while(*charRead != (char)32 && *charRead != EOF && *charRead != (char)10 && *charRead != (char)13) {
-        if(*charRead == '.') {
+    size_t slash = 0;
+    for (size_t i = 0; i < word.length; i++) {
+        if (digits[i] == '.') {
             if (type == DOUBLE_TYPE) {
                 printf("Syntax error: Multiple use of dot within number");
                 texit(1);
             }
+            if (type == RATIONAL_TYPE) {
+                printf("Syntax error: Improper number");
+                texit(1);
+            }
             type = DOUBLE_TYPE;
         }
-        else if (isParenOrQuote((charRead)) || *charRead == EOF || *charRead == (char)10 || *charRead == (char)13) {
-            break;
+        else if (digits[i] == '/') {
+            if (type != INT_TYPE || i == 0) {
+                printf("Syntax error: Improper number");
+                texit(1);
+            }
+            type = RATIONAL_TYPE;
+            slash = i;
         }
-        else if (!isdigit(*charRead)) {
+        else if (!isdigit((unsigned char)digits[i])) {
             printf("Syntax error: Improper number");
             texit(1);
         }
-        new = catLetter(new, charRead);
-        nextChar(charRead, false);
     }
-    Value *numVal = makeNull();
-    numVal->type = type;
     if (type == DOUBLE_TYPE) {
+        // atof needs a NUL after the number, which the source may not have.
+        char *copy = tallocKind(word.length + 1, ATOMIC_KIND);
+        memcpy(copy, digits, word.length);
+        Value *numVal = makeValue(DOUBLE_TYPE);
         if (sign == '-') {
-            numVal->d = -1*atof(new);
+            numVal->d = -1*atof(copy);
         }
         else {
-            numVal->d = atof(new);
+            numVal->d = atof(copy);
         }
+        return numVal;
     }
-    else{
-        if (sign == '-') {
-            numVal->i = -1*atoi(new);
-        }
-        else {
-            numVal->i = atoi(new);
+    if (type == RATIONAL_TYPE) {
+        Value *denominator = parseInteger(digits + slash + 1, word.length - slash - 1, false);
+        if (denominator == makeInt(0)) {
+            printf("Syntax error: Division by zero in number");
+            texit(1);
         }
-
+        return makeRational(parseInteger(digits, slash, sign == '-'), denominator);
     }
-    return numVal;
+    return parseInteger(digits, word.length, sign == '-');
 }
 
-// Creates Boolean type Value
-Value *tokenizeBoolean(char *charRead) {
-    char* new = talloc(sizeof(char[255]));
-    new[0] = '\0';
-    new = catLetter(new, charRead);
-    nextChar(charRead, false);
-    if(!(*charRead == 'f' || *charRead == 't')) {
+// Creates Boolean type Value, or the open token of a vector literal #(, for
+// a cursor at the #.
+Value *tokenizeHash(Source *source) {
+    source->position++;
+    int charRead = peekChar(source);
+    if (charRead == '(') {
+        source->position++;
+        return makeToken(OPEN_VECTOR_TYPE, "(");
+    }
+    if(!(charRead == 'f' || charRead == 't')) {
         printf("Syntax error: Improper use of #");
         texit(1);
     }
-    new = catLetter(new, charRead);
-    nextChar(charRead, false);
-    if (*charRead == EOF) {
-        Value *boolVal = makeNull();
-        boolVal->type = BOOL_TYPE;
-        boolVal->s = new;
-        return boolVal;
-    }
-    else if(!(isParenOrQuote(charRead) || *charRead == (char)32 || *charRead == (char)10 || *charRead == (char)13)) {
+    source->position++;
+    if (!isDelimiter(peekChar(source))) {
         printf("Syntax Error: Missing space after boolean");
         texit(1);
     }
-    Value *boolVal = makeNull();
-    boolVal->type = BOOL_TYPE;
-    boolVal->s = new;
-    return boolVal;
+    return makeBool(charRead == 't');
 }
 
 // Checks if char is a valid <initial> according to grammar
-bool isSymbolInitial (char const *charRead) {
-    for(int i = 0; i < 14; i++) {
-        if(*charRead == misc[i]) return true;
-    }
-    return (bool)isalpha(*charRead);
+bool isSymbolInitial(unsigned char c) {
+    return charClasses[c] & CHAR_INITIAL;
 }
 
-// Checks if char is a valid <subsequent> according to grammar
-bool isSymbolSubsequent(char *s) {
-    return (isSymbolInitial(s) || isdigit(*s) || (*s == '+') || (*s == '-') || (*s == '.'));
-}
-
-// Creates a Symbol Type Value
-Value *tokenizeSymbol(char *charRead) {
-    char *str = talloc(sizeof(char*));
-    str[0] = '\0';
-    while (*charRead != (char)32) {
-        if(isParenOrQuote((charRead)) || *charRead == EOF || *charRead == (char)10 || *charRead == '\r') {
-            break;
-        }
-        if (!isSymbolSubsequent(charRead)) {
-            printf("Syntax Error: Improper symbol");
-            texit(1);
-        }
-        str = catLetter(str, charRead);
-        nextChar(charRead, false);
+// Creates a Symbol Type Value, interned so that equal symbols share one Value.
+// Every character must be a valid <subsequent> according to grammar.
+Value *tokenizeSymbol(Source *source) {
+    Slice word = scanWord(source);
+    if (!(word.classes & CHAR_SYMBOL)) {
+        printf("Syntax Error: Improper symbol");
+        texit(1);
     }
-    Value *symbolVal = makeNull();
-    symbolVal->type = SYMBOL_TYPE;
-    symbolVal->s = str;
-    return symbolVal;
+    return internSlice(source->text + word.offset, word.length);
 }
 
-// Read all of the input from stdin, and return a linked list consisting of the
-// tokens.
-Value *tokenize(char *inputFileName) {
-    inputFile = fopen(inputFileName, "r");
-    char charRead;
-    Value *list = makeNull();
-    nextChar(&charRead, false);
-
-    while(charRead != EOF) {
+// Returns the next token of a source, or NULL at the end of it.
+Value *nextToken(Source *source) {
+    releaseRead(source);
+    while(hasMore(source)) {
+        source->start = source->position;
+        char charRead = source->text[source->position];
 
         // Brackets
         if (charRead == '(' || charRead == ')' || charRead == '[' || charRead == ']') {
-            list = cons(tokenizeBracket(charRead), list);
-            nextChar(&charRead, false);
+            source->position++;
+            return tokenizeBracket(charRead);
+        }
+
+            // Comments
+        else if (charRead == ';') {
+            skipComment(source);
         }
 
             // Strings
         else if (charRead == '"'){
-            list = cons(tokenizeString(&charRead), list);
-            nextChar(&charRead, false);
-
+            return tokenizeString(source);
         }
             // Single Quote
         else if (charRead == '\'') {
-            list = cons(makeStringValue(&charRead, SINGLE_QUOTE_TYPE), list);
-            nextChar(&charRead, false);
+            source->position++;
+            return makeToken(SINGLE_QUOTE_TYPE, "'");
         }
             // Symbols + or -
         else if (charRead == '+' || charRead == '-') {
-            char sign = charRead;
-            nextChar(&charRead, false);
-            if(charRead == (char)32 || isParenOrQuote(&charRead)) {
-                list = cons(makeStringValue(&sign, SYMBOL_TYPE), list);
+            source->position++;
+            if (isDelimiter(peekChar(source))) {
+                return intern(charRead == '+' ? "+" : "-");
             }
-            else if (isdigit(charRead)){
-                list = cons(tokenizeNumber(&charRead, sign), list);
+            else if (isdigit(peekChar(source))) {
+                return tokenizeNumber(source, charRead);
             }
             else {
                 printf("Syntax error: Symbol starting with +/-");
@@ -258,56 +415,68 @@ Value *tokenize(char *inputFileName) {
         }
 
             // Symbols
-        else if (isSymbolInitial(&charRead)) {
-            list = cons(tokenizeSymbol(&charRead), list);
+        else if (isSymbolInitial((unsigned char)charRead)) {
+            return tokenizeSymbol(source);
         }
 
             // Integers
-        else if (isdigit(charRead) || charRead == '+' || charRead == '-') {
-            char sign = '+';
-            if (charRead == '-') sign = '-';
-            list = cons(tokenizeNumber(&charRead, sign), list);
+        else if (charClasses[(unsigned char)charRead] & CHAR_DIGIT) {
+            return tokenizeNumber(source, '+');
         }
-            // Booleans
+            // Booleans and vectors
         else if (charRead == '#') {
-            list = cons(tokenizeBoolean(&charRead), list);
+            return tokenizeHash(source);
         }
 
-
-
             // Dots
         else if (charRead == '.') {
-            Value *dotVal = makeStringValue(&charRead, DOT_TYPE);
-            nextChar(&charRead, false);
-            if(!(charRead == (char)32 || isParenOrQuote(&charRead) || isdigit(charRead) || charRead == '"' || charRead == EOF)) {
+            source->position++;
+            int next = peekChar(source);
+            if(!(isDelimiter(next) || isdigit(next) || next == '"')) {
                 printf("Syntax Error: Dot misplacement");
                 texit(1);
             }
-            list = cons(dotVal, list);
+            return makeToken(DOT_TYPE, ".");
+        }
+            // Whitespace
+        else if (charClasses[(unsigned char)charRead] & CHAR_WHITESPACE) {
+            skipWhitespace(source);
         }
         else {
-            nextChar(&charRead, false);
+            source->position++;
         }
     }
-    fclose(inputFile);
-    Value *revList = reverse(list);
-    return revList;
+    return NULL;
+}
+
+// Read all of the input from the named file, and return a linked list
+// consisting of the tokens.
+Value *tokenize(char *inputFileName) {
+    Source *source = openSource(inputFileName);
+    Value *list = makeNull();
+    Value *token;
+    while ((token = nextToken(source)) != NULL) {
+        list = cons(token, list);
+    }
+    closeSource(source);
+    return reverse(list);
 }
 
 // Displays the contents of the linked list as tokens, with type information
 void displayTokens(Value *list) {
     Value *newList = list;
-    while (newList->type == CONS_TYPE) {
+    while (typeOf(newList) == CONS_TYPE) {
         Value *listCar = newList->c.car;
-        switch (listCar->type) {
+        switch (typeOf(listCar)) {
             case INT_TYPE:
-                printf("%i:Integer\n", listCar->i);
+                printf("%i:Integer\n", intValue(listCar));
                 break;
             case DOUBLE_TYPE:
                 printf("%f:Double\n", listCar->d);
                 break;
             case STR_TYPE:
-                printf("%s:String\n", listCar->s);
+                writeString(listCar, true);
+                printf(":String\n");
                 break;
             case OPEN_TYPE:
                 printf("%s:Open\n", listCar->s);
@@ -315,6 +484,9 @@ void displayTokens(Value *list) {
             case OPEN_BRACKET_TYPE:
                 printf("%s:Open Bracket\n", listCar->s);
                 break;
+            case OPEN_VECTOR_TYPE:
+                printf("#%s:Open Vector\n", listCar->s);
+                break;
             case CLOSE_TYPE:
                 printf("%s:Close\n", listCar->s);
                 break;
@@ -322,7 +494,7 @@ void displayTokens(Value *list) {
                 printf("%s:Close Bracket\n", listCar->s);
                 break;
             case BOOL_TYPE:
-                printf("%s:Boolean\n", listCar->s);
+                printf("%s:Boolean\n", listCar == TRUE_VALUE ? "#t" : "#f");
                 break;
             case SYMBOL_TYPE:
                 printf("%s:Symbol\n", listCar->s);
@@ -338,4 +510,3 @@ void displayTokens(Value *list) {
         newList = cdr(newList);
     }
 }
-
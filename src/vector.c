@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include "value.h"
+#include "vector.h"
+#include "interpreter.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// A vector's elements are kept in one array block, which the collector traces
+// element by element, so indexing is constant time however long the vector
+// is. The VECTOR_TYPE Value holds the array and the count. Like cons cells,
+// vectors are mutable, and vector-set! calls the write barrier.
+
+// Returns a new vector of count elements, each of them fill.
+Value *makeVector(int64_t count, Value *fill) {
+    Value **items = tallocKind(sizeof(Value *) * count, ARRAY_KIND);
+    for (int64_t i = 0; i < count; i++) {
+        items[i] = fill;
+    }
+    Value *vector = makeValue(VECTOR_TYPE);
+    vector->vec.items = items;
+    vector->vec.count = count;
+    return vector;
+}
+
+// Returns a new vector holding the elements of a list, in order. Exits if
+// list isn't a proper list.
+Value *vectorFromList(Value *list) {
+    int64_t count = 0;
+    Value *current = list;
+    while (typeOf(current) == CONS_TYPE) {
+        count++;
+        current = cdr(current);
+    }
+    if (typeOf(current) != NULL_TYPE) {
+        printf("list->vector: contract violation\n"
+               "  expected: list?");
+        texit(1);
+    }
+    Value *vector = makeVector(count, NULL_VALUE);
+    for (int64_t i = 0; i < count; i++) {
+        vector->vec.items[i] = car(list);
+        list = cdr(list);
+    }
+    tbarrier(vector->vec.items);
+    return vector;
+}
+
+// Exits unless value is a vector.
+void checkIsVector(char *name, Value *value) {
+    if (typeOf(value) != VECTOR_TYPE) {
+        printf("%s: contract violation\n"
+               "  expected: vector?", name);
+        texit(1);
+    }
+}
+
+// Exits unless index is a valid index into vector.
+void checkVectorIndex(char *name, Value *vector, Value *index) {
+    if (typeOf(index) != INT_TYPE || intValue(index) < 0 || intValue(index) >= vector->vec.count) {
+        printf("%s: index is out of range", name);
+        texit(1);
+    }
+}
+
+// Primitive function for making a vector of a given size, filled with its
+// second argument or with 0.
+Value *primitiveMakeVector(int argc, Value **argv) {
+    if (typeOf(argv[0]) != INT_TYPE || intValue(argv[0]) < 0) {
+        printf("make-vector: contract violation\n"
+               "  expected: exact-nonnegative-integer?");
+        texit(1);
+    }
+    return makeVector(intValue(argv[0]), argc == 2 ? argv[1] : makeInt(0));
+}
+
+// Primitive function for making a vector of its arguments.
+Value *primitiveVector(int argc, Value **argv) {
+    Value *vector = makeVector(argc, NULL_VALUE);
+    for (int i = 0; i < argc; i++) {
+        vector->vec.items[i] = argv[i];
+    }
+    tbarrier(vector->vec.items);
+    return vector;
+}
+
+// Primitive function for the number of elements in a vector.
+Value *primitiveVectorLength(int argc, Value **argv) {
+    checkIsVector("vector-length", argv[0]);
+    return makeInt((int)argv[0]->vec.count);
+}
+
+// Primitive function for getting an element of a vector by index.
+Value *primitiveVectorRef(int argc, Value **argv) {
+    checkIsVector("vector-ref", argv[0]);
+    checkVectorIndex("vector-ref", argv[0], argv[1]);
+    return argv[0]->vec.items[intValue(argv[1])];
+}
+
+// Primitive function for replacing an element of a vector.
+Value *primitiveVectorSet(int argc, Value **argv) {
+    checkIsVector("vector-set!", argv[0]);
+    checkVectorIndex("vector-set!", argv[0], argv[1]);
+    argv[0]->vec.items[intValue(argv[1])] = argv[2];
+    tbarrier(argv[0]->vec.items);
+    return VOID_VALUE;
+}
+
+// Primitive function for a list of the elements of a vector. The list is
+// built from the end.
+Value *primitiveVectorToList(int argc, Value **argv) {
+    checkIsVector("vector->list", argv[0]);
+    Value *list = makeNull();
+    for (int64_t i = argv[0]->vec.count - 1; i >= 0; i--) {
+        list = cons(argv[0]->vec.items[i], list);
+    }
+    return list;
+}
+
+// Primitive function for a vector of the elements of a list.
+Value *primitiveListToVector(int argc, Value **argv) {
+    return vectorFromList(argv[0]);
+}
+
+// Binds the vector primitives as global variables.
+void bindVectors() {
+    bind("make-vector", primitiveMakeVector, 1, 2);
+    bind("vector", primitiveVector, 0, -1);
+    bind("vector-length", primitiveVectorLength, 1, 1);
+    bind("vector-ref", primitiveVectorRef, 2, 2);
+    bind("vector-set!", primitiveVectorSet, 3, 3);
+    bind("vector->list", primitiveVectorToList, 1, 1);
+    bind("list->vector", primitiveListToVector, 1, 1);
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "value.h"
+#include "interpreter.h"
+#include "analyze.h"
+#include "compiler.h"
+#include "vm.h"
+#include "talloc.h"
+#include "linkedlist.h"
+#include "parser.h"
+
+
+// Where to pick up again when a call returns: the caller's code, frame and
+// next instruction, where the called procedure sits on the stack, and the top
+// of the frame stack before the call.
+typedef struct {
+    Code *code;
+    Frame *frame;
+    int pc;
+    int base;
+    char *frames;
+} CallRecord;
+
+// The value stack and the call stack, shared by every run of the VM. They
+// are malloc'd and grow as needed, up to stackLimit bytes between them. The
+// collector finds the Values and frames in them through traceStacks. Entries
+// below stackMark and callMark haven't been written since the last
+// collection.
+Value **stack = NULL;
+int sp = 0;
+int stackSize = 0;
+int stackMark = 0;
+CallRecord *calls = NULL;
+int callCount = 0;
+int callsSize = 0;
+int callMark = 0;
+size_t stackLimit = DEFAULT_STACK_LIMIT;
+
+// The messages JUMP_IF_FALSE_OP exits with, by testKind.
+char *testMessages[] = {"Evaluation Error", "cond: argument not boolean",
+                        "and: arguments not boolean type"};
+
+// Sets how many bytes the VM's stacks may take up in all.
+void setStackLimit(size_t bytes) {
+    stackLimit = bytes;
+}
+
+// Reports the pointers on the stacks to the collector. A minor collection
+// only needs the ones written since the last collection.
+void traceStacks(void (*visit)(void **), bool young) {
+    for (int i = young ? stackMark : 0; i < sp; i++) {
+        visit((void **)&stack[i]);
+    }
+    for (int i = young ? callMark : 0; i < callCount; i++) {
+        visit((void **)&calls[i].code);
+        visit((void **)&calls[i].frame);
+    }
+    stackMark = sp;
+    callMark = callCount;
+}
+
+// Doubles the size of one of the stacks, whose items are of the given size,
+// and returns the new array. Exits if that would take the stacks over the
+// limit.
+void *growStack(void *array, int *capacity, size_t size) {
+    size_t total = stackSize * sizeof(Value *) + callsSize * sizeof(CallRecord);
+    if (total + *capacity * size > stackLimit) {
+        printf("stack depth exceeded");
+        texit(1);
+    }
+    *capacity *= 2;
+    void *grown = realloc(array, size * *capacity);
+    if (grown == NULL) {
+        printf("stack depth exceeded");
+        texit(1);
+    }
+    return grown;
+}
+
+// Pushes a value, growing the stack if it is full.
+void pushValue(Value *value) {
+    if (sp == stackSize) {
+        stack = growStack(stack, &stackSize, sizeof(Value *));
+    }
+    if (sp < stackMark) {
+        stackMark = sp;
+    }
+    stack[sp++] = value;
+}
+
+// Saves where to return to, growing the call stack if it is full.
+void pushCall(Code *code, Frame *frame, int pc, int base, char *frames) {
+    if (callCount == callsSize) {
+        calls = growStack(calls, &callsSize, sizeof(CallRecord));
+    }
+    if (callCount < callMark) {
+        callMark = callCount;
+    }
+    calls[callCount++] = (CallRecord){code, frame, pc, base, frames};
+}
+
+// Runs a parsed file at top level, printing the value of each expression.
+Value *runForms(Value *tree) {
+    while (typeOf(tree) != NULL_TYPE) {
+        Value *result = runCode(compile(analyze(car(tree))), NULL);
+        if (typeOf(result) != VOID_TYPE) {
+            printTree(result);
+            printf("\n");
+        }
+        tree = cdr(tree);
+    }
+    return VOID_VALUE;
+}
+
+// Runs compiled code in a frame and returns its value. Calls to closures run
+// on the VM's own stack rather than recursing in C, and tail calls reuse the
+// caller's place on it.
+Value *runCode(Code *code, Frame *frame) {
+    if (stack == NULL) {
+        stackSize = 512;
+        callsSize = 128;
+        stack = growStack(NULL, &stackSize, sizeof(Value *));
+        calls = growStack(NULL, &callsSize, sizeof(CallRecord));
+        taddtracer(traceStacks);
+    }
+    int firstCall = callCount;
+    int firstBase = sp;
+    char *firstFrames = frameStackTop();
+    int pc = 0;
+    while (true) {
+        int *ops = code->ops;
+        switch (ops[pc++]) {
+            case CONSTANT_OP:
+                pushValue(code->constants[ops[pc++]]);
+                break;
+            case LOCAL_OP:
+                pushValue(lookUpLocal(code->constants[ops[pc++]], frame));
+                break;
+            case SET_LOCAL_OP:
+                setLocal(code->constants[ops[pc++]], stack[--sp], frame, true);
+                break;
+            case BIND_OP:
+                frame->slots[ops[pc++]] = stack[--sp];
+                frameBarrier(frame);
+                break;
+            case GLOBAL_OP:
+                pushValue(lookUpGlobal(code->constants[ops[pc++]]));
+                break;
+            case SET_GLOBAL_OP:
+                setGlobal(code->constants[ops[pc++]], stack[--sp]);
+                break;
+            case DEFINE_GLOBAL_OP:
+                defineGlobal(code->constants[ops[pc++]], stack[--sp]);
+                break;
+            case POP_OP:
+                sp--;
+                break;
+            case JUMP_OP:
+                pc = ops[pc];
+                break;
+            case JUMP_IF_FALSE_OP: {
+                Value *condition = stack[--sp];
+                if (condition != TRUE_VALUE && condition != FALSE_VALUE) {
+                    printf("%s", testMessages[ops[pc + 1]]);
+                    texit(1);
+                }
+                pc = condition == FALSE_VALUE ? ops[pc] : pc + 2;
+                break;
+            }
+            case CLOSURE_OP: {
+                Value *closure = makeValue(CLOSURE_TYPE);
+                closure->cl.code = code->constants[ops[pc++]];
+                closure->cl.frame = frame;
+                pushValue(closure);
+                break;
+            }
+            case CALL_OP:
+            case TAIL_CALL_OP: {
+                bool isTail = ops[pc - 1] == TAIL_CALL_OP;
+                int argc = ops[pc++];
+                int base = sp - argc - 1;
+                Value *function = stack[base];
+                if (typeOf(function) == CLOSURE_TYPE) {
+                    Node *lambda = function->cl.code;
+                    if (lambda->let.count != argc) {
+                        printf("#<procedure>: arity mismatch;\n"
+                               " the expected number of arguments does not match the given number\n");
+                        texit(1);
+                    }
+                    if (isTail) {
+                        releaseFrames(callCount == firstCall ? firstFrames : calls[callCount - 1].frames);
+                    }
+                    else {
+                        pushCall(code, frame, pc, base, frameStackTop());
+                    }
+                    Frame *newFrame = enterFrame(function->cl.frame, lambda->let.slots, lambda->let.escapes);
+                    memcpy(newFrame->slots, stack + base + 1, sizeof(Value *) * argc);
+                    if (isTail) {
+                        sp = callCount == firstCall ? firstBase : calls[callCount - 1].base;
+                    }
+                    code = compileLambda(lambda);
+                    frame = newFrame;
+                    pc = 0;
+                    break;
+                }
+                if (typeOf(function) != PRIMITIVE_TYPE) {
+                    printf("application: not a procedure;\n"
+                           " expected a procedure that can be applied to arguments");
+                    texit(1);
+                }
+                Value *result = applyPrimitive(function, argc, stack + base + 1);
+                if (function->prim->function == primitiveLoadFile) {
+                    result = runForms(result);
+                }
+                sp = base;
+                pushValue(result);
+                break;
+            }
+            case RETURN_OP: {
+                Value *result = stack[--sp];
+                if (callCount == firstCall) {
+                    releaseFrames(firstFrames);
+                    return result;
+                }
+                CallRecord *record = &calls[--callCount];
+                code = record->code;
+                frame = record->frame;
+                pc = record->pc;
+                sp = record->base;
+                releaseFrames(record->frames);
+                pushValue(result);
+                break;
+            }
+            case FRAME_OP:
+                frame = enterFrame(frame, ops[pc], ops[pc + 1]);
+                pc += 2;
+                break;
+            case LEAVE_OP:
+                frame = frame->parent;
+                break;
+            case DISPLAY_OP:
+                displayValue(stack[--sp]);
+                pushValue(VOID_VALUE);
+                break;
+        }
+    }
+}
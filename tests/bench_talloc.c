@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "value.h"
+#include "linkedlist.h"
+#include "talloc.h"
+
+// Microbenchmark for talloc: builds long lists with cons and releases them
+// with tfree, and compares that against the old scheme where every allocation
+// did a malloc for the payload plus a malloc for a PTR_TYPE Value and another
+// for the cons cell that tracked it.
+
+Value *oldList = NULL;
+
+void *oldTalloc(size_t size) {
+    void *new = malloc(size);
+    Value *p = malloc(sizeof(Value));
+    p->type = PTR_TYPE;
+    p->p = new;
+    Value *node = malloc(sizeof(Value));
+    node->type = CONS_TYPE;
+    node->c.car = p;
+    node->c.cdr = oldList;
+    oldList = node;
+    return new;
+}
+
+void oldTfree() {
+    while (oldList != NULL) {
+        Value *next = oldList->c.cdr;
+        free(oldList->c.car->p);
+        free(oldList->c.car);
+        free(oldList);
+        oldList = next;
+    }
+}
+
+Value *oldCons(Value *newCar, Value *newCdr) {
+    Value *node = oldTalloc(sizeof(Value));
+    node->type = CONS_TYPE;
+    node->c.car = newCar;
+    node->c.cdr = newCdr;
+    return node;
+}
+
+double seconds(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+    int cells = 1000000;
+    int rounds = 10;
+    if (argc > 1) {
+        cells = atoi(argv[1]);
+    }
+
+    clock_t start = clock();
+    for (int r = 0; r < rounds; r++) {
+        Value *list = oldTalloc(sizeof(Value));
+        list->type = NULL_TYPE;
+        for (int i = 0; i < cells; i++) {
+            list = oldCons(list, list);
+        }
+        oldTfree();
+    }
+    double oldTime = seconds(start);
+
+    start = clock();
+    int chunks = 0;
+    for (int r = 0; r < rounds; r++) {
+        Value *list = makeNull();
+        for (int i = 0; i < cells; i++) {
+            list = cons(list, list);
+        }
+        chunks = getChunkCount();
+        tfree();
+    }
+    double newTime = seconds(start);
+
+    printf("%d rounds of %d cons cells\n", rounds, cells);
+    printf("tracked mallocs: %.3fs\n", oldTime);
+    printf("bump chunks:     %.3fs (%d chunks per round)\n", newTime, chunks);
+    printf("speedup:         %.1fx\n", oldTime / newTime);
+    return 0;
+}
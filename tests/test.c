@@ -1,21 +1,648 @@
 #include <stdlib.h>
+#include <stdio.h>
 #include <tokenizer.h>
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/wait.h>
 #include "unity.h"
 #include "linkedlist.h"
 #include "talloc.h"
 #include "parser.h"
 #include "interpreter.h"
+#include "bignum.h"
+#include "rational.h"
+#include "str.h"
+#include "hashtable.h"
+#include "symbol.h"
+#include "kernels.h"
 
 
 void test1() {
     TEST_ASSERT_EQUAL_INT(1,1);
 }
 
+// Returns the integer written in decimal in text, which may start with a
+// minus sign.
+Value *integer(char *text) {
+    bool negative = text[0] == '-';
+    char *digits = text + negative;
+    return parseInteger(digits, strlen(digits), negative);
+}
+
+// Asserts that two integers are equal, and that the first is a fixnum exactly
+// when it fits in one.
+void assertInteger(Value *expected, Value *actual) {
+    TEST_ASSERT_EQUAL_INT(0, integerCompare(expected, actual));
+    int64_t n;
+    bool fits = integerToInt64(actual, &n) && n >= INT_MIN && n <= INT_MAX;
+    TEST_ASSERT_EQUAL_INT(fits ? INT_TYPE : BIGNUM_TYPE, typeOf(actual));
+}
+
+// Divides a by b, and asserts the quotient and remainder, and that
+// quotient * b + remainder is a again.
+void assertDivide(char *a, char *b, char *quotient, char *remainder) {
+    Value *q;
+    Value *r;
+    integerDivide(integer(a), integer(b), &q, &r);
+    assertInteger(integer(quotient), q);
+    assertInteger(integer(remainder), r);
+    assertInteger(integer(a), integerAdd(integerMultiply(q, integer(b)), r));
+}
+
+void testFixnumOverflow() {
+    Value *max = makeInt(INT_MAX);
+    Value *min = makeInt(INT_MIN);
+    assertInteger(integer("2147483648"), integerAdd(max, makeInt(1)));
+    assertInteger(integer("-2147483649"), integerSubtract(min, makeInt(1)));
+    assertInteger(integer("2147483648"), integerMultiply(min, makeInt(-1)));
+    assertInteger(integer("2147483648"), integerMultiply(makeInt(65536), makeInt(32768)));
+    assertInteger(integer("4611686014132420609"), integerMultiply(max, max));
+    assertDivide("-2147483648", "-1", "2147483648", "0");
+}
+
+void testBignumDemotion() {
+    TEST_ASSERT_EQUAL_INT(INT_TYPE, typeOf(integer("2147483647")));
+    TEST_ASSERT_EQUAL_INT(BIGNUM_TYPE, typeOf(integer("2147483648")));
+    TEST_ASSERT_EQUAL_INT(INT_TYPE, typeOf(integer("-2147483648")));
+    TEST_ASSERT_EQUAL_INT(BIGNUM_TYPE, typeOf(integer("-2147483649")));
+    assertInteger(makeInt(INT_MAX), integerSubtract(integer("2147483648"), makeInt(1)));
+    assertInteger(makeInt(INT_MIN), integerAdd(integer("-2147483649"), makeInt(1)));
+    assertInteger(makeInt(0), integerSubtract(integer("18446744073709551616"),
+                                              integer("18446744073709551616")));
+    assertInteger(makeInt(-7), integerAdd(integer("9223372036854775808"),
+                                          integer("-9223372036854775815")));
+    assertDivide("18446744073709551616", "9223372036854775808", "2", "0");
+}
+
+void testBignumCarries() {
+    assertInteger(integer("18446744073709551616"),
+                  integerAdd(integer("18446744073709551615"), makeInt(1)));
+    assertInteger(integer("18446744073709551615"),
+                  integerSubtract(integer("18446744073709551616"), makeInt(1)));
+    assertInteger(integer("340282366920938463426481119284349108225"),
+                  integerMultiply(integer("18446744073709551615"),
+                                  integer("18446744073709551615")));
+}
+
+// Knuth's algorithm D guesses each quotient digit from the top digits, and
+// for these the guess is still one too big after it has been corrected, so
+// the divisor has to be added back.
+void testKnuthAddBack() {
+    assertDivide("170141183420855150446885018808547803137", "39614081266355540833626750975",
+                 "4294967293", "39614081257132168801066942462");
+    assertDivide("340282366841710300930663525758072258561", "79228162514264337589248983038",
+                 "4294967294", "79228162514264337587101499389");
+    assertDivide("-340282366841710300930663525758072258561", "79228162514264337589248983038",
+                 "-4294967294", "-79228162514264337587101499389");
+}
+
+// The quotient is rounded toward zero, and the remainder has the sign of the
+// dividend, for fixnums and bignums alike.
+void testDivisionSigns() {
+    assertDivide("7", "2", "3", "1");
+    assertDivide("7", "-2", "-3", "1");
+    assertDivide("-7", "2", "-3", "-1");
+    assertDivide("-7", "-2", "3", "-1");
+    assertDivide("1000000000000000000000000000007", "100000000000000000003",
+                 "9999999999", "99999999970000000010");
+    assertDivide("1000000000000000000000000000007", "-100000000000000000003",
+                 "-9999999999", "99999999970000000010");
+    assertDivide("-1000000000000000000000000000007", "100000000000000000003",
+                 "-9999999999", "-99999999970000000010");
+    assertDivide("-1000000000000000000000000000007", "-100000000000000000003",
+                 "9999999999", "-99999999970000000010");
+    assertDivide("-1000000000000000000000000000007", "7", "-142857142857142857142857142858", "-1");
+    assertDivide("5", "-100000000000000000003", "0", "5");
+}
+
+// Asserts that an exact number is numerator / denominator, in lowest terms,
+// and that it is an integer exactly when the denominator is 1.
+void assertRational(char *numerator, char *denominator, Value *actual) {
+    if (!strcmp(denominator, "1")) {
+        assertInteger(integer(numerator), actual);
+        return;
+    }
+    TEST_ASSERT_EQUAL_INT(RATIONAL_TYPE, typeOf(actual));
+    assertInteger(integer(numerator), actual->rat.numerator);
+    assertInteger(integer(denominator), actual->rat.denominator);
+}
+
+// Returns numerator / denominator for two fixnums.
+Value *ratio(int numerator, int denominator) {
+    return makeRational(makeInt(numerator), makeInt(denominator));
+}
+
+void testRationalLowestTerms() {
+    assertRational("3", "2", ratio(6, 4));
+    assertRational("-3", "2", ratio(6, -4));
+    assertRational("3", "2", ratio(-6, -4));
+    assertRational("1", "3", makeRational(makeInt(INT_MIN),
+                                          integerMultiply(makeInt(INT_MIN), makeInt(3))));
+    Value *big = integer("1267650600228229401496703205376");
+    assertRational("1", "3", makeRational(integerMultiply(big, makeInt(3)),
+                                          integerMultiply(big, makeInt(9))));
+    assertRational("-1", "2", makeRational(integerMultiply(big, makeInt(-6)),
+                                           integerMultiply(big, makeInt(12))));
+    assertRational("110456735171150155873297237685611775616741942302947011749743045913474",
+                   "12341192071761151484915977700427660072260831289763694414605",
+                   exactAdd(makeRational(integer("6988328543308192938465812368554719267148"),
+                                         integer("780797157184699260681239349367")),
+                            makeRational(makeInt(-603444932),
+                                         integer("221282425806508693961100492410"))));
+}
+
+// A ratio whose denominator comes out as 1 is an integer, fixnum or bignum.
+void testRationalToInteger() {
+    assertRational("2", "1", ratio(10, 5));
+    assertRational("-2", "1", ratio(10, -5));
+    assertRational("0", "1", ratio(0, -5));
+    Value *big = integer("1267650600228229401496703205376");
+    assertRational("7", "1", makeRational(integerMultiply(big, makeInt(7)), big));
+    assertRational("1267650600228229401496703205376", "1",
+                   makeRational(integerMultiply(big, makeInt(3)), makeInt(3)));
+    Value *third = ratio(1, 3);
+    assertRational("1", "1", exactAdd(third, ratio(2, 3)));
+    assertRational("0", "1", exactSubtract(third, third));
+    assertRational("1", "1", exactMultiply(ratio(2, 3), ratio(3, 2)));
+    assertRational("3", "2", exactDivide(makeInt(6), makeInt(4)));
+    assertRational("-3", "1", exactDivide(makeInt(6), ratio(-2, 1)));
+}
+
+// The remainder of rationals takes a whole number of divisors away, and has
+// the sign of the dividend.
+void testRationalRemainder() {
+    Value *third = ratio(1, 3);
+    assertRational("1", "6", exactRemainder(ratio(7, 2), third));
+    assertRational("-1", "6", exactRemainder(ratio(-7, 2), third));
+    assertRational("1", "6", exactRemainder(ratio(7, 2), ratio(-1, 3)));
+    assertRational("0", "1", exactRemainder(ratio(2, 3), third));
+    assertRational("1", "1", exactRemainder(makeInt(7), makeInt(-2)));
+}
+
+// Returns the slot of an 8-slot eq? table that key starts probing at.
+int homeSlot(Value *key) {
+    Value *table = makeHashTable(false);
+    hashTableSet(table, key, key);
+    int i = 0;
+    while (table->ht.slots[3 * i] == NULL) {
+        i++;
+    }
+    return i;
+}
+
+// Asserts that key maps to value in a table, or to nothing if value is NULL.
+void assertMapping(Value *table, Value *key, Value *value) {
+    TEST_ASSERT_EQUAL_PTR(value, hashTableRef(table, key));
+}
+
+// Keys that start at the same slot sit one after another, and removing the
+// first shifts the rest back, so each can still be found.
+void testHashTableDisplacement() {
+    Value *keys[4];
+    int home = homeSlot(makeInt(0));
+    int found = 0;
+    for (int n = 1; found < 3; n++) {
+        if (homeSlot(makeInt(n)) == home) {
+            keys[found++] = makeInt(n);
+        }
+    }
+    // A key that starts right after them, and so is pushed along too.
+    int n = 0;
+    while (homeSlot(makeInt(n)) != ((home + 1) & 7)) {
+        n++;
+    }
+    keys[3] = makeInt(n);
+
+    Value *table = makeHashTable(false);
+    for (int i = 0; i < 4; i++) {
+        hashTableSet(table, keys[i], makeInt(i));
+    }
+    TEST_ASSERT_EQUAL_INT(3, table->ht.sizeLog);
+    TEST_ASSERT_EQUAL_PTR(keys[3], table->ht.slots[3 * ((home + 3) & 7) + 1]);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(hashTableRemove(table, keys[i]));
+        TEST_ASSERT_FALSE(hashTableRemove(table, keys[i]));
+        assertMapping(table, keys[i], NULL);
+        for (int j = i + 1; j < 4; j++) {
+            assertMapping(table, keys[j], makeInt(j));
+        }
+        TEST_ASSERT_EQUAL_INT(3 - i, table->ht.count);
+    }
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_NULL(table->ht.slots[3 * i]);
+    }
+}
+
+// Entries survive the table doubling many times over, and removing some of
+// them afterwards leaves the rest reachable.
+void testHashTableGrowth() {
+    Value *table = makeHashTable(false);
+    for (int i = 0; i < 5000; i++) {
+        hashTableSet(table, makeInt(i), makeInt(-i));
+    }
+    TEST_ASSERT_EQUAL_INT(5000, table->ht.count);
+    TEST_ASSERT_EQUAL_INT(13, table->ht.sizeLog);
+    for (int i = 0; i < 5000; i += 3) {
+        TEST_ASSERT_TRUE(hashTableRemove(table, makeInt(i)));
+    }
+    for (int i = 0; i < 5000; i++) {
+        assertMapping(table, makeInt(i), i % 3 == 0 ? NULL : makeInt(-i));
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        hashTableSet(table, makeInt(i), makeInt(i));
+    }
+    TEST_ASSERT_EQUAL_INT(5000, table->ht.count);
+    for (int i = 0; i < 5000; i++) {
+        assertMapping(table, makeInt(i), makeInt(i % 3 == 0 ? i : -i));
+    }
+}
+
+// Returns a new double.
+Value *real(double d) {
+    Value *value = makeValue(DOUBLE_TYPE);
+    value->d = d;
+    return value;
+}
+
+// Returns a new key that is equal? to every other one made with the same n,
+// but eq? to none of them.
+Value *equalKey(int n) {
+    switch (n) {
+        case 0:
+            return makeString("hash me", 7);
+        case 1:
+            return integer("-123456789012345678901234567890");
+        case 2:
+            return makeRational(integer("1267650600228229401496703205376"), makeInt(3));
+        case 3:
+            return real(0.0);
+        case 4:
+            return cons(makeInt(1), cons(makeString("two", 3), cons(ratio(3, 4), makeNull())));
+        default:
+            return cons(real(2.5), cons(integer("98765432109876543210"), makeNull()));
+    }
+}
+
+void testHashTableEqualKeys() {
+    Value *equal = makeHashTable(true);
+    Value *eq = makeHashTable(false);
+    for (int n = 0; n < 6; n++) {
+        hashTableSet(equal, equalKey(n), makeInt(n));
+        hashTableSet(eq, equalKey(n), makeInt(n));
+    }
+    for (int n = 0; n < 6; n++) {
+        assertMapping(equal, equalKey(n), makeInt(n));
+        assertMapping(eq, equalKey(n), NULL);
+        hashTableSet(equal, equalKey(n), makeInt(-n));
+    }
+    assertMapping(equal, real(-0.0), makeInt(-3));
+    assertMapping(equal, real(1e-300), NULL);
+    assertMapping(equal, integer("123456789012345678901234567890"), NULL);
+    assertMapping(equal, ratio(1, 3), NULL);
+    TEST_ASSERT_EQUAL_INT(6, equal->ht.count);
+    for (int n = 0; n < 6; n++) {
+        TEST_ASSERT_TRUE(hashTableRemove(equal, equalKey(n)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, equal->ht.count);
+}
+
+#define SOURCE_DATUMS 4000
+#define LONG_TOKEN 150000
+#define STREAM_FORMS 5000
+
+// Writes the text the source tests read into a new buffer, and sets *length.
+// Each datum is a list of a fixnum, a string, a symbol and a bignum. They are
+// separated by varying amounts of whitespace and comments, so their tokens
+// start and end at every offset into a 64KB buffer, and followed by a string
+// and a symbol longer than the buffer.
+char *sourceText(size_t *length) {
+    char *text = malloc(SOURCE_DATUMS * 200 + 2 * LONG_TOKEN + 16);
+    size_t n = 0;
+    for (int k = 0; k < SOURCE_DATUMS; k++) {
+        n += sprintf(text + n, "(%i \"s-%i", k, k);
+        memset(text + n, 'x', k % 29);
+        n += k % 29;
+        n += sprintf(text + n, "\" sym-%i", k);
+        memset(text + n, 'y', k % 31);
+        n += k % 31;
+        n += sprintf(text + n, " %i%020i)", k + 1, k);
+        memset(text + n, k % 2 ? ' ' : '\n', k % 37);
+        n += k % 37;
+        if (k % 5 == 0) {
+            n += sprintf(text + n, "; comment %i\n", k);
+        }
+    }
+    text[n++] = '"';
+    memset(text + n, 'z', LONG_TOKEN);
+    n += LONG_TOKEN;
+    n += sprintf(text + n, "\" ");
+    memset(text + n, 'w', LONG_TOKEN);
+    n += LONG_TOKEN;
+    *length = n;
+    return text;
+}
+
+// Reads the datums written by sourceText from a source, and checks each.
+void assertSourceDatums(Source *source) {
+    char expected[100];
+    for (int k = 0; k < SOURCE_DATUMS; k++) {
+        Value *datum = readDatum(source);
+        TEST_ASSERT_EQUAL_INT(4, length(datum));
+        TEST_ASSERT_EQUAL_PTR(makeInt(k), car(datum));
+        Value *string = car(cdr(datum));
+        int n = sprintf(expected, "s-%i", k);
+        memset(expected + n, 'x', k % 29);
+        TEST_ASSERT_EQUAL_INT(STR_TYPE, typeOf(string));
+        TEST_ASSERT_EQUAL_INT(n + k % 29, string->str.length);
+        TEST_ASSERT_EQUAL_MEMORY(expected, string->str.bytes, n + k % 29);
+        n = sprintf(expected, "sym-%i", k);
+        memset(expected + n, 'y', k % 31);
+        TEST_ASSERT_EQUAL_PTR(internSlice(expected, n + k % 31), car(cdr(cdr(datum))));
+        n = sprintf(expected, "%i%020i", k + 1, k);
+        assertInteger(integer(expected), car(cdr(cdr(cdr(datum)))));
+    }
+    Value *string = readDatum(source);
+    TEST_ASSERT_EQUAL_INT(STR_TYPE, typeOf(string));
+    TEST_ASSERT_EQUAL_INT(LONG_TOKEN, string->str.length);
+    TEST_ASSERT_EACH_EQUAL_UINT8('z', string->str.bytes, LONG_TOKEN);
+    Value *symbol = readDatum(source);
+    TEST_ASSERT_EQUAL_INT(SYMBOL_TYPE, typeOf(symbol));
+    TEST_ASSERT_EQUAL_INT(LONG_TOKEN, strlen(symbol->s));
+    TEST_ASSERT_EACH_EQUAL_UINT8('w', symbol->s, LONG_TOKEN);
+    TEST_ASSERT_NULL(readDatum(source));
+}
+
+// Opens a source on a pipe that a child process writes text into, chunk bytes
+// at a time, so that the reads filling its buffer end at arbitrary points.
+Source *openPipeSource(char *text, size_t length, size_t chunk) {
+    int ends[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(ends));
+    if (fork() == 0) {
+        close(ends[0]);
+        for (size_t i = 0; i < length; i += chunk) {
+            size_t count = length - i < chunk ? length - i : chunk;
+            if (write(ends[1], text + i, count) != (ssize_t)count) {
+                _exit(1);
+            }
+        }
+        _exit(0);
+    }
+    close(ends[1]);
+    char path[32];
+    sprintf(path, "/dev/fd/%i", ends[0]);
+    Source *source = openSource(path);
+    close(ends[0]);
+    return source;
+}
+
+// Tokens that straddle the end of what a piped source has read, and ones
+// longer than its buffer, come out whole.
+void testPipeSource() {
+    size_t length;
+    char *text = sourceText(&length);
+    size_t chunks[] = {65536, 4093, 31};
+    for (int i = 0; i < 3; i++) {
+        Source *source = openPipeSource(text, length, chunks[i]);
+        assertSourceDatums(source);
+        closeSource(source);
+        int status;
+        wait(&status);
+        TEST_ASSERT_EQUAL_INT(0, status);
+    }
+    free(text);
+}
+
+// The same text reads the same from a mapped file.
+void testMappedSource() {
+    size_t length;
+    char *text = sourceText(&length);
+    char path[] = "/tmp/sourceXXXXXX";
+    int file = mkstemp(path);
+    TEST_ASSERT_TRUE(file >= 0);
+    TEST_ASSERT_EQUAL_INT(length, write(file, text, length));
+    close(file);
+    Source *source = openSource(path);
+    assertSourceDatums(source);
+    closeSource(source);
+    unlink(path);
+    free(text);
+}
+
+// Asserts that a set of kernels classifies the 32 characters at text by the
+// classes in charClasses.
+void assertClassified(Kernels *set, char *text) {
+    CharMasks masks = set->classifyChars(text);
+    for (int i = 0; i < 32; i++) {
+        unsigned char classes = charClasses[(unsigned char)text[i]];
+        TEST_ASSERT_EQUAL_INT((classes & CHAR_WHITESPACE) != 0, (masks.whitespace >> i) & 1);
+        TEST_ASSERT_EQUAL_INT((classes & CHAR_DELIMITER) != 0, (masks.delimiters >> i) & 1);
+        TEST_ASSERT_EQUAL_INT((classes & CHAR_DIGIT) != 0, (masks.digits >> i) & 1);
+        TEST_ASSERT_EQUAL_INT((classes & CHAR_SYMBOL) != 0, (masks.symbols >> i) & 1);
+    }
+}
+
+// Every set of kernels the CPU supports classifies every character the same,
+// at every position in a block, and reads a source the same.
+void testClassifyKernels() {
+    char *names[] = {"scalar", "sse2", "avx2"};
+    char *best = getKernels()->name;
+    size_t length;
+    char *text = sourceText(&length);
+    char path[] = "/tmp/sourceXXXXXX";
+    int file = mkstemp(path);
+    TEST_ASSERT_EQUAL_INT(length, write(file, text, length));
+    close(file);
+    for (int i = 0; i < 3; i++) {
+        if (!selectKernels(names[i])) {
+            continue;
+        }
+        Kernels *set = getKernels();
+        char block[32];
+        for (int c = 0; c < 256; c += 32) {
+            for (int j = 0; j < 32; j++) {
+                block[j] = (char)(c + j);
+            }
+            assertClassified(set, block);
+        }
+        uint32_t seed = 1;
+        for (int n = 0; n < 10000; n++) {
+            for (int j = 0; j < 32; j++) {
+                seed = seed * 1103515245 + 12345;
+                block[j] = (char)(seed >> 16);
+            }
+            assertClassified(set, block);
+        }
+        Source *source = openSource(path);
+        assertSourceDatums(source);
+        closeSource(source);
+    }
+    selectKernels(best);
+    unlink(path);
+    free(text);
+}
+
+// Returns a pseudo-random number, from a seed it updates.
+uint32_t nextRandom(uint32_t *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+// Asserts that two arrays of doubles hold the same bits, except that a NaN
+// may have any sign and payload, since arithmetic on NaNs does not fix them.
+void assertSameDoubles(double *expected, double *actual, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        if (isnan(expected[i])) {
+            TEST_ASSERT_TRUE(isnan(actual[i]));
+        } else {
+            TEST_ASSERT_EQUAL_MEMORY(&expected[i], &actual[i], sizeof(double));
+        }
+    }
+}
+
+// Asserts that two arrays of integers are the same, which may be empty.
+void assertSameIntegers(int64_t *expected, int64_t *actual, int64_t n) {
+    if (n > 0) {
+        TEST_ASSERT_EQUAL_INT64_ARRAY(expected, actual, n);
+    }
+}
+
+// Asserts that every set of kernels the CPU supports does what the portable
+// ones do with n elements. Sums, dots and scans of doubles may add in any
+// order, so the doubles they get are whole numbers, whose sums are exact.
+void assertNumericKernels(Kernels *scalar, Kernels *set, int64_t n, uint32_t *seed) {
+    double special[] = {0.0, -0.0, NAN, -NAN, 1.5, -2.5, INFINITY, -INFINITY, 1e300, 3.0};
+    int64_t edges[] = {0, -1, 1, INT64_MAX, INT64_MIN, INT64_MAX - 1, INT64_MIN + 1, 3};
+    double a[9], b[9], whole[9], expected[9], actual[9];
+    int64_t c[9], d[9], expectedS[9], actualS[9];
+    for (int64_t i = 0; i < n; i++) {
+        a[i] = special[nextRandom(seed) % 10];
+        b[i] = special[nextRandom(seed) % 10];
+        whole[i] = (double)(int)(nextRandom(seed) % 2001) - 1000;
+        c[i] = edges[nextRandom(seed) % 8];
+        d[i] = (int64_t)nextRandom(seed) - 16384;
+    }
+    for (kernelOp op = KERNEL_ADD; op <= KERNEL_DIVIDE; op++) {
+        for (int scalarB = 0; scalarB < 2; scalarB++) {
+            scalar->mapF64(op, expected, a, b, scalarB, n);
+            set->mapF64(op, actual, a, b, scalarB, n);
+            assertSameDoubles(expected, actual, n);
+            if (op != KERNEL_DIVIDE) {
+                scalar->mapS64(op, expectedS, c, d, scalarB, n);
+                set->mapS64(op, actualS, c, d, scalarB, n);
+                assertSameIntegers(expectedS, actualS, n);
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(scalar->sumF64(whole, n) == set->sumF64(whole, n));
+    TEST_ASSERT_TRUE(scalar->dotF64(whole, whole, n) == set->dotF64(whole, whole, n));
+    scalar->scanF64(expected, whole, n);
+    set->scanF64(actual, whole, n);
+    assertSameDoubles(expected, actual, n);
+    TEST_ASSERT_EQUAL_INT64(scalar->sumS64(c, n), set->sumS64(c, n));
+    TEST_ASSERT_EQUAL_INT64(scalar->dotS64(c, d, n), set->dotS64(c, d, n));
+    scalar->scanS64(expectedS, c, n);
+    set->scanS64(actualS, c, n);
+    assertSameIntegers(expectedS, actualS, n);
+    if (n > 0) {
+        expected[0] = scalar->minF64(a, n);
+        actual[0] = set->minF64(a, n);
+        expected[1] = scalar->maxF64(a, n);
+        actual[1] = set->maxF64(a, n);
+        assertSameDoubles(expected, actual, 2);
+        TEST_ASSERT_EQUAL_INT64(scalar->minS64(c, n), set->minS64(c, n));
+        TEST_ASSERT_EQUAL_INT64(scalar->maxS64(c, n), set->maxS64(c, n));
+    }
+}
+
+// Every set of kernels the CPU supports agrees with the portable one, at
+// every length up to two whole AVX2 vectors and a tail.
+void testNumericKernels() {
+    char *names[] = {"sse2", "avx2"};
+    char *best = getKernels()->name;
+    selectKernels("scalar");
+    Kernels *scalar = getKernels();
+    for (int i = 0; i < 2; i++) {
+        if (!selectKernels(names[i])) {
+            continue;
+        }
+        uint32_t seed = 1;
+        for (int64_t n = 0; n <= 9; n++) {
+            for (int trial = 0; trial < 2000; trial++) {
+                assertNumericKernels(scalar, getKernels(), n, &seed);
+            }
+        }
+    }
+    selectKernels(best);
+}
+
+// The min and max of doubles follow one rule for NaNs and zeros.
+void testNumericKernelExtremes() {
+    char *names[] = {"scalar", "sse2", "avx2"};
+    char *best = getKernels()->name;
+    double withNaN[] = {1.0, 2.0, 3.0, 4.0, NAN, 5.0, 6.0, 7.0, 0.5};
+    double leadingNaN[] = {NAN, 1.0, 2.0, 3.0, 4.0, 5.0};
+    double zeros[] = {0.0, 1.0, -0.0, 3.0, 0.0, -1.0, 1.0, 0.0};
+    for (int i = 0; i < 3; i++) {
+        if (!selectKernels(names[i])) {
+            continue;
+        }
+        Kernels *set = getKernels();
+        TEST_ASSERT_TRUE(1.0 == set->minF64(withNaN, 8));
+        TEST_ASSERT_TRUE(7.0 == set->maxF64(withNaN, 8));
+        TEST_ASSERT_TRUE(0.5 == set->minF64(withNaN, 9));
+        TEST_ASSERT_TRUE(3.0 == set->minF64((double[]){3.0, NAN}, 2));
+        TEST_ASSERT_TRUE(isnan(set->minF64(leadingNaN, 6)));
+        TEST_ASSERT_TRUE(isnan(set->maxF64(leadingNaN, 6)));
+        TEST_ASSERT_TRUE(signbit(set->minF64(zeros, 5)));
+        TEST_ASSERT_FALSE(signbit(set->maxF64((double[]){-0.0, -1.0, 0.0, -0.0, -2.0}, 5)));
+        TEST_ASSERT_EQUAL_INT64(INT64_MIN, set->sumS64((int64_t[]){INT64_MAX, 1}, 2));
+    }
+    selectKernels(best);
+}
+
+// Forms read from a pipe are run as they are read, each defining a variable
+// from the one before it.
+void testInterpretPipe() {
+    char *text = malloc(STREAM_FORMS * 80);
+    size_t length = sprintf(text, "(define v0 0)");
+    for (int k = 1; k < STREAM_FORMS; k++) {
+        length += sprintf(text + length, "\n(define v%i\n  (+ v%i 1))%*s", k, k - 1, k % 41, "");
+    }
+    Source *source = openPipeSource(text, length, 1000);
+    interpret(source, false);
+    closeSource(source);
+    int status;
+    wait(&status);
+    TEST_ASSERT_EQUAL_INT(0, status);
+    char name[16];
+    sprintf(name, "v%i", STREAM_FORMS - 1);
+    TEST_ASSERT_EQUAL_PTR(makeInt(STREAM_FORMS - 1), eval(internSlice(name, strlen(name))));
+    free(text);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test1);
-    texit(0);
-    return UNITY_END();
+    RUN_TEST(testFixnumOverflow);
+    RUN_TEST(testBignumDemotion);
+    RUN_TEST(testBignumCarries);
+    RUN_TEST(testKnuthAddBack);
+    RUN_TEST(testDivisionSigns);
+    RUN_TEST(testRationalLowestTerms);
+    RUN_TEST(testRationalToInteger);
+    RUN_TEST(testRationalRemainder);
+    RUN_TEST(testHashTableDisplacement);
+    RUN_TEST(testHashTableGrowth);
+    RUN_TEST(testHashTableEqualKeys);
+    RUN_TEST(testPipeSource);
+    RUN_TEST(testMappedSource);
+    RUN_TEST(testClassifyKernels);
+    RUN_TEST(testNumericKernels);
+    RUN_TEST(testNumericKernelExtremes);
+    RUN_TEST(testInterpretPipe);
+    int failures = UNITY_END();
+    tfree();
+    return failures;
 }